@@ -27,8 +27,12 @@
 #include "configstore.hh"
 #include "configstore_changes.hh"
 #include "configstore_json.hh"
+#include "configstore_iter.hh"
 #include "device_models.hh"
+#include "models_reload.hh"
 #include "report_roon.hh"
+#include "report_state_shm.hh"
+#include "usb_hotplug.hh"
 #include "dbus.hh"
 #include "dbus/de_tahifi_jsonio.hh"
 #include "monitor_manager.hh"
@@ -37,7 +41,9 @@
 #include "versioninfo.h"
 
 #include <glib.h>
+#include <gio/gio.h>
 #include <iostream>
+#include <future>
 #include <cstring>
 
 static void show_version_info(void)
@@ -62,6 +68,10 @@ struct Parameters
     bool run_in_foreground_;
     MessageVerboseLevel verbose_level_;
     const char *device_models_file_;
+    const char *compiled_models_file_;
+    unsigned int prebuild_threads_;
+    bool watch_models_file_;
+    const char *state_shm_name_;
 
     Parameters(const Parameters &) = delete;
     Parameters(Parameters &&) = default;
@@ -71,7 +81,11 @@ struct Parameters
     explicit Parameters():
         run_in_foreground_(false),
         verbose_level_(MESSAGE_LEVEL_NORMAL),
-        device_models_file_("/var/local/etc/models.json")
+        device_models_file_("/var/local/etc/models.json"),
+        compiled_models_file_(nullptr),
+        prebuild_threads_(0),
+        watch_models_file_(true),
+        state_shm_name_(StateSHM::DEFAULT_NAME)
     {}
 };
 
@@ -87,6 +101,12 @@ static void usage(const char *program_name)
         "  --quiet        Short for \"--verbose quite\".\n"
         "  --fg           Run in foreground, don't run as daemon.\n"
         "  --config       Path to device definitions configuration file.\n"
+        "  --models-cache Path to compiled device definitions (created if\n"
+        "                 missing or outdated).\n"
+        "  --prebuild n   Build all device models at startup using n threads.\n"
+        "  --no-reload    Do not reload device definitions when they change.\n"
+        "  --state-shm    Name of shared memory object for state publication.\n"
+        "  --no-state-shm Do not publish state through shared memory.\n"
         ;
 }
 
@@ -143,6 +163,40 @@ static int process_command_line(int argc, char *argv[],
 
             parameters.device_models_file_ = argv[i];
         }
+        else if(strcmp(argv[i], "--models-cache") == 0)
+        {
+            if(!check_argument(argc, argv, i))
+                return -1;
+
+            parameters.compiled_models_file_ = argv[i];
+        }
+        else if(strcmp(argv[i], "--prebuild") == 0)
+        {
+            if(!check_argument(argc, argv, i))
+                return -1;
+
+            char *endptr;
+            const auto n = strtoul(argv[i], &endptr, 10);
+
+            if(*argv[i] == '\0' || *endptr != '\0' || n > 64)
+            {
+                std::cerr << "Invalid number of threads \"" << argv[i] << "\".\n";
+                return -1;
+            }
+
+            parameters.prebuild_threads_ = n;
+        }
+        else if(strcmp(argv[i], "--no-reload") == 0)
+            parameters.watch_models_file_ = false;
+        else if(strcmp(argv[i], "--state-shm") == 0)
+        {
+            if(!check_argument(argc, argv, i))
+                return -1;
+
+            parameters.state_shm_name_ = argv[i];
+        }
+        else if(strcmp(argv[i], "--no-state-shm") == 0)
+            parameters.state_shm_name_ = nullptr;
         else
         {
             std::cerr << "Unknown option \"" << argv[i]
@@ -179,6 +233,135 @@ static bool setup(const Parameters &parameters)
     return true;
 }
 
+/*
+ * Device models built in the background during startup. The model cache must
+ * not be used before they are done.
+ */
+static std::future<size_t> prebuilt_models;
+
+static void wait_for_prebuilt_models()
+{
+    if(!prebuilt_models.valid())
+        return;
+
+    /* called from GLib callbacks, so nothing must be thrown from here; any
+     * models not prebuilt are built on demand */
+    try
+    {
+        prebuilt_models.get();
+    }
+    catch(const std::exception &e)
+    {
+        msg_error(0, LOG_ERR, "Failed prebuilding device models: %s", e.what());
+    }
+}
+
+/*
+ * Reload of the device models file while running. Changed models are rebuilt
+ * on a worker thread and swapped into the model cache on the main thread, so
+ * that the settings never see a partially updated cache (see
+ * models_reload.hh).
+ */
+struct ModelsWatch
+{
+    const Parameters &parameters_;
+    StaticModels::DeviceModelCache &cache_;
+    ConfigStore::Settings &settings_;
+    const ClientPlugin::PluginManager &pm_;
+    std::future<std::unique_ptr<StaticModels::DeviceModelCache::Reload>> pending_;
+    bool is_outdated_;
+
+    ModelsWatch(const ModelsWatch &) = delete;
+    ModelsWatch(ModelsWatch &&) = delete;
+    ModelsWatch &operator=(const ModelsWatch &) = delete;
+    ModelsWatch &operator=(ModelsWatch &&) = delete;
+
+    explicit ModelsWatch(const Parameters &parameters,
+                         StaticModels::DeviceModelCache &cache,
+                         ConfigStore::Settings &settings,
+                         const ClientPlugin::PluginManager &pm):
+        parameters_(parameters),
+        cache_(cache),
+        settings_(settings),
+        pm_(pm),
+        is_outdated_(false)
+    {}
+};
+
+static void start_models_reload(ModelsWatch &mr);
+
+static gboolean finish_models_reload(gpointer user_data)
+{
+    auto &mr(*static_cast<ModelsWatch *>(user_data));
+    auto reload(mr.pending_.get());
+
+    if(reload != nullptr)
+        ModelsReload::apply(mr.cache_, mr.settings_, mr.pm_, std::move(*reload));
+
+    if(mr.is_outdated_)
+    {
+        mr.is_outdated_ = false;
+        start_models_reload(mr);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+static void start_models_reload(ModelsWatch &mr)
+{
+    if(mr.pending_.valid())
+    {
+        mr.is_outdated_ = true;
+        return;
+    }
+
+    wait_for_prebuilt_models();
+
+    mr.pending_ = std::async(std::launch::async,
+        [&mr, hashes = mr.cache_.get_definition_hashes()]
+        {
+            auto reload(ModelsReload::load_changed(mr.parameters_.device_models_file_,
+                                                   mr.parameters_.compiled_models_file_,
+                                                   hashes));
+            g_idle_add(finish_models_reload, &mr);
+            return reload;
+        });
+}
+
+static void models_file_changed(GFileMonitor *monitor, GFile *file,
+                                GFile *other_file, GFileMonitorEvent event_type,
+                                gpointer user_data)
+{
+    if(event_type != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT &&
+       event_type != G_FILE_MONITOR_EVENT_CREATED)
+        return;
+
+    msg_vinfo(MESSAGE_LEVEL_DEBUG, "Device models file changed");
+    start_models_reload(*static_cast<ModelsWatch *>(user_data));
+}
+
+static bool watch_models_file(ModelsWatch &mr)
+{
+    GFile *file = g_file_new_for_path(mr.parameters_.device_models_file_);
+    GError *error = nullptr;
+    GFileMonitor *monitor =
+        g_file_monitor_file(file, G_FILE_MONITOR_NONE, nullptr, &error);
+    g_object_unref(file);
+
+    if(monitor == nullptr)
+    {
+        msg_error(0, LOG_ERR, "Cannot watch device models file \"%s\": %s",
+                  mr.parameters_.device_models_file_, error->message);
+        g_error_free(error);
+        return false;
+    }
+
+    /* the monitor lives as long as the process */
+    g_signal_connect(monitor, "changed", G_CALLBACK(models_file_changed), &mr);
+
+    return true;
+}
+
 static void process_dcpd_audio_path_update(
         tdbusJSONEmitter *const object,
         const gchar *const json, GVariant *extra,
@@ -187,12 +370,15 @@ static void process_dcpd_audio_path_update(
         > *const d)
 {
     auto &settings(std::get<1>(d->user_data));
+    const bool was_stale = settings.is_stale();
+
+    wait_for_prebuilt_models();
 
     try
     {
         msg_info("Received audio path update");
         msg_info("%s", json);
-        settings.update(json);
+        settings.update(json, ConfigStore::Settings::UpdateMode::DETECT_FULL_STATE);
     }
     catch(const std::exception &e)
     {
@@ -203,7 +389,8 @@ static void process_dcpd_audio_path_update(
     ConfigStore::Changes changes;
     ConfigStore::SettingsJSON js(settings);
 
-    if(js.extract_changes(changes))
+    /* an unchanged state must be reported as well if it was stale before */
+    if(js.extract_changes(changes) || was_stale != settings.is_stale())
         std::get<0>(d->user_data).report_changes(settings, changes);
 }
 
@@ -274,11 +461,18 @@ static void listen_to_dcpd_audio_path_updates(TDBus::Bus &bus,
             dcpd_appeared(connection, requests_for_dcpd_proxy,
                           updates_from_dcpd_proxy, pm, settings);
         },
-        [&settings]
+        [&pm, &settings]
         (GDBusConnection *connection, const char *name)
         {
             msg_vinfo(MESSAGE_LEVEL_DEBUG, "Lost DCPD (audio paths)");
-            settings.clear();
+
+            /* keep data around so that the full state sent by DCPD on
+             * reconnect can be applied as a set of differences */
+            settings.invalidate();
+
+            /* let clients know that the state is outdated */
+            ConfigStore::Changes changes;
+            pm.report_changes(settings, changes);
         });
 }
 
@@ -358,6 +552,166 @@ create_roon_plugin(TDBus::Bus &bus, ClientPlugin::MonitorManager &mm,
     return roon;
 }
 
+static std::unique_ptr<ClientPlugin::StateSHMPublisher>
+create_state_shm_plugin(const char *shm_name)
+{
+    if(shm_name == nullptr)
+        return nullptr;
+
+    try
+    {
+        auto plugin(std::make_unique<ClientPlugin::StateSHMPublisher>(
+                std::make_unique<StateSHM::Writer>(shm_name)));
+        plugin->add_client();
+        return plugin;
+    }
+    catch(const std::exception &e)
+    {
+        msg_error(0, LOG_ERR, "State not published: %s", e.what());
+        return nullptr;
+    }
+}
+
+static const StaticModels::DeviceModel *
+get_own_device_model(const ConfigStore::Settings &settings)
+{
+    try
+    {
+        return ConfigStore::SettingsIterator(settings).with_device("self").get_model();
+    }
+    catch(const std::exception &e)
+    {
+        return nullptr;
+    }
+}
+
+static nlohmann::json
+handle_usb_request(const char *json, USBHotplug::EventProcessor &ep,
+                   const ConfigStore::Settings &settings)
+{
+    const auto req(nlohmann::json::parse(json));
+    nlohmann::json answer = nlohmann::json::object();
+
+    if(req.contains("resolve"))
+    {
+        const auto &what(req["resolve"]);
+        const StaticModels::UsbConnector *conn = nullptr;
+
+        if(what.contains("device_path"))
+            conn = ep.resolve(what["device_path"].get<std::string>());
+        else if(what.contains("audio_source"))
+        {
+            const auto *model = get_own_device_model(settings);
+            if(model != nullptr)
+                conn = model->get_usb_connectors().lookup_by_audio_source(
+                                    what["audio_source"].get<std::string>());
+        }
+
+        if(conn != nullptr)
+            answer["connector"] = USBHotplug::EventProcessor::to_json(*conn);
+    }
+    else if(req.contains("hotplug"))
+        ep.process_json(req.at("hotplug"));
+
+    return answer;
+}
+
+static gboolean usb_request(
+        tdbusJSONReceiver *const object,
+        GDBusMethodInvocation *const invocation,
+        const gchar *const json, GVariant *extra,
+        TDBus::MethodHandlerTraits<TDBus::JSONReceiverTell>::template UserData<
+            USBHotplug::EventProcessor &, const ConfigStore::Settings &
+        > *const d)
+{
+    std::string answer;
+
+    try
+    {
+        answer = handle_usb_request(json, std::get<0>(d->user_data),
+                                    std::get<1>(d->user_data)).dump();
+    }
+    catch(const std::exception &e)
+    {
+        nlohmann::json error;
+        error["error"] = "exception";
+        error["message"] = e.what();
+        answer = error.dump();
+    }
+
+    const char *const empty_extra[] = {nullptr};
+    d->done(invocation, answer.c_str(), empty_extra);
+    return TRUE;
+}
+
+static gboolean usb_request_ignore_errors(
+        tdbusJSONReceiver *const object,
+        GDBusMethodInvocation *const invocation,
+        const gchar *const json, GVariant *extra,
+        TDBus::MethodHandlerTraits<TDBus::JSONReceiverNotify>::template UserData<
+            USBHotplug::EventProcessor &, const ConfigStore::Settings &
+        > *const d)
+{
+    try
+    {
+        handle_usb_request(json, std::get<0>(d->user_data),
+                           std::get<1>(d->user_data));
+    }
+    catch(const std::exception &e)
+    {
+        msg_error(0, LOG_NOTICE, "Failed processing USB request: %s", e.what());
+    }
+
+    d->done(invocation);
+    return TRUE;
+}
+
+static gboolean get_plugged_usb_connectors(
+        tdbusJSONEmitter *const object,
+        GDBusMethodInvocation *const invocation,
+        GVariant *params,
+        TDBus::MethodHandlerTraits<TDBus::JSONEmitterGet>::template UserData<
+            const USBHotplug::EventProcessor &
+        > *const d)
+{
+    static const char *const empty_extra[] = {nullptr};
+    d->done(invocation, std::get<0>(d->user_data).json().dump().c_str(),
+            empty_extra);
+    return TRUE;
+}
+
+/*
+ * Resolution of USB connectors defined in the model of our own appliance,
+ * and processing of USB hotplug events reported by external processes.
+ */
+static void export_usb_connectors(TDBus::Bus &bus,
+                                  const ConfigStore::Settings &settings)
+{
+    static constexpr char object_name[] = "/de/tahifi/AuPaD/USB";
+
+    static TDBus::Iface<tdbusJSONEmitter> emitter_iface(object_name);
+    static USBHotplug::EventProcessor ep(
+        [&settings] { return get_own_device_model(settings); },
+        [] (const nlohmann::json &event)
+        {
+            static const char *const empty_extra[] = {nullptr};
+            emitter_iface.emit(tdbus_jsonemitter_emit_object,
+                               event.dump().c_str(), empty_extra);
+        });
+
+    static TDBus::Iface<tdbusJSONReceiver> requests_iface(object_name);
+    requests_iface.connect_method_handler<TDBus::JSONReceiverTell>(
+        usb_request, ep, settings);
+    requests_iface.connect_method_handler<TDBus::JSONReceiverNotify>(
+        usb_request_ignore_errors, ep, settings);
+    bus.add_auto_exported_interface(requests_iface);
+
+    emitter_iface.connect_method_handler<TDBus::JSONEmitterGet>(
+        get_plugged_usb_connectors,
+        *const_cast<const USBHotplug::EventProcessor *>(&ep));
+    bus.add_auto_exported_interface(emitter_iface);
+}
+
 int main(int argc, char *argv[])
 {
     static Parameters parameters;
@@ -382,16 +736,41 @@ int main(int argc, char *argv[])
     TDBus::setup(TDBus::session_bus());
 
     static StaticModels::DeviceModelsDatabase models_database;
-    models_database.load(parameters.device_models_file_);
-    models_database.flatten();
+    if(parameters.compiled_models_file_ != nullptr)
+        models_database.load_compiled(parameters.device_models_file_,
+                                      parameters.compiled_models_file_);
+    else
+    {
+        models_database.load(parameters.device_models_file_);
+        models_database.flatten();
+    }
 
-    static ConfigStore::Settings settings(models_database);
+    static StaticModels::DeviceModelCache model_cache(models_database, true);
+    static ConfigStore::Settings settings(model_cache);
+
+    if(parameters.prebuild_threads_ > 0)
+        prebuilt_models =
+            std::async(std::launch::async,
+                       [threads = parameters.prebuild_threads_]
+                       { return model_cache.prebuild(threads); });
 
     ClientPlugin::PluginManager pm;
     ClientPlugin::MonitorManager mm(TDBus::session_bus());
     pm.register_plugin(create_roon_plugin(TDBus::session_bus(), mm, settings));
 
+    auto state_publisher(create_state_shm_plugin(parameters.state_shm_name_));
+    if(state_publisher != nullptr)
+    {
+        state_publisher->publish(settings);
+        pm.register_plugin(std::move(state_publisher));
+    }
+
     listen_to_dcpd_audio_path_updates(TDBus::session_bus(), pm, settings);
+    export_usb_connectors(TDBus::session_bus(), settings);
+
+    static ModelsWatch models_watch(parameters, model_cache, settings, pm);
+    if(parameters.watch_models_file_)
+        watch_models_file(models_watch);
 
     auto *loop = g_main_loop_new(nullptr, false);
     g_main_loop_run(loop);
@@ -0,0 +1,654 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "device_models.hh"
+#include "signal_path_tracker.hh"
+#include "messages.h"
+
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <new>
+#include <cstring>
+#include <cstdlib>
+#include <malloc.h>
+#include <unistd.h>
+
+/*
+ * Allocation statistics for the whole process. Bytes are counted as usable
+ * size reported by the allocator so that frees can be accounted for, too.
+ */
+static std::atomic<size_t> allocations_count;
+static std::atomic<size_t> allocations_bytes;
+static std::atomic<ssize_t> live_bytes;
+
+void *operator new(size_t size)
+{
+    void *p = malloc(size > 0 ? size : 1);
+    if(p == nullptr)
+        throw std::bad_alloc();
+
+    const size_t usable = malloc_usable_size(p);
+    ++allocations_count;
+    allocations_bytes += usable;
+    live_bytes += usable;
+
+    return p;
+}
+
+#if !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void *p) noexcept
+{
+    if(p == nullptr)
+        return;
+
+    live_bytes -= malloc_usable_size(p);
+    free(p);
+}
+
+#if !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+void operator delete(void *p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+struct Parameters
+{
+    const char *device_models_file_;
+    std::vector<std::string> device_ids_;
+    unsigned int repeat_;
+    bool pretty_;
+    bool bench_;
+
+    Parameters(const Parameters &) = delete;
+    Parameters(Parameters &&) = default;
+    Parameters &operator=(const Parameters &) = delete;
+    Parameters &operator=(Parameters &&) = default;
+
+    explicit Parameters():
+        device_models_file_(nullptr),
+        repeat_(1),
+        pretty_(false),
+        bench_(false)
+    {}
+};
+
+static void usage(const char *program_name)
+{
+    std::cout <<
+        "Usage: " << program_name << " [options] models.json [device ID...]\n"
+        "\n"
+        "Build device models and report timings, allocations, graph sizes,\n"
+        "and errors as JSON object on stdout. All models are built if no\n"
+        "device ID is given. Models with identical definitions are built\n"
+        "only once. The exit code is non-zero if any model failed to build.\n"
+        "\n"
+        "Options:\n"
+        "  --help         Show this help.\n"
+        "  --repeat n     Build each model n times, report best timings.\n"
+        "  --bench        Measure signal path queries on each model instead\n"
+        "                 of building it; --repeat n reports the best of n\n"
+        "                 runs.\n"
+        "  --pretty       Indent JSON output.\n"
+        ;
+}
+
+static int process_command_line(int argc, char *argv[],
+                                Parameters &parameters)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        if(strcmp(argv[i], "--help") == 0)
+            return 1;
+        else if(strcmp(argv[i], "--pretty") == 0)
+            parameters.pretty_ = true;
+        else if(strcmp(argv[i], "--bench") == 0)
+            parameters.bench_ = true;
+        else if(strcmp(argv[i], "--repeat") == 0)
+        {
+            if(i + 1 >= argc)
+            {
+                std::cerr << "Option " << argv[i] << " requires an argument.\n";
+                return -1;
+            }
+
+            ++i;
+
+            char *endptr;
+            const auto n = strtoul(argv[i], &endptr, 10);
+
+            if(*argv[i] == '\0' || *endptr != '\0' || n == 0 || n > 10000)
+            {
+                std::cerr << "Invalid repeat count \"" << argv[i] << "\".\n";
+                return -1;
+            }
+
+            parameters.repeat_ = n;
+        }
+        else if(argv[i][0] == '-' && argv[i][1] == '-')
+        {
+            std::cerr << "Unknown option \"" << argv[i]
+                      << "\". Please try --help.\n";
+            return -1;
+        }
+        else if(parameters.device_models_file_ == nullptr)
+            parameters.device_models_file_ = argv[i];
+        else
+            parameters.device_ids_.emplace_back(argv[i]);
+    }
+
+    if(parameters.device_models_file_ == nullptr)
+    {
+        std::cerr << "No models file given. Please try --help.\n";
+        return -1;
+    }
+
+    return 0;
+}
+
+/*!
+ * Time and allocations measured between two points.
+ *
+ * This is a plain structure so that taking a measurement does not allocate
+ * anything by itself.
+ */
+struct Sample
+{
+    bool is_valid_;
+    long long us_;
+    size_t allocations_;
+    size_t allocated_bytes_;
+    ssize_t retained_bytes_;
+
+    explicit Sample():
+        is_valid_(false),
+        us_(0),
+        allocations_(0),
+        allocated_bytes_(0),
+        retained_bytes_(0)
+    {}
+
+    nlohmann::json json() const
+    {
+        nlohmann::json result;
+        result["us"] = us_;
+        result["allocations"] = allocations_;
+        result["allocated_bytes"] = allocated_bytes_;
+        result["retained_bytes"] = retained_bytes_;
+        return result;
+    }
+};
+
+/*!
+ * Measure time and allocations between two points.
+ */
+class Probe
+{
+  private:
+    std::chrono::steady_clock::time_point time_;
+    size_t count_;
+    size_t bytes_;
+    ssize_t live_;
+
+  public:
+    explicit Probe() { reset(); }
+
+    void reset()
+    {
+        count_ = allocations_count;
+        bytes_ = allocations_bytes;
+        live_ = live_bytes;
+        time_ = std::chrono::steady_clock::now();
+    }
+
+    Sample take()
+    {
+        const auto now(std::chrono::steady_clock::now());
+
+        Sample result;
+        result.is_valid_ = true;
+        result.us_ =
+            std::chrono::duration_cast<std::chrono::microseconds>(now - time_).count();
+        result.allocations_ = allocations_count - count_;
+        result.allocated_bytes_ = allocations_bytes - bytes_;
+        result.retained_bytes_ = live_bytes - live_;
+
+        reset();
+        return result;
+    }
+};
+
+/*!
+ * Keep the fastest of several measurements of the same phase.
+ */
+static void keep_best(Sample &best, const Sample &sample)
+{
+    if(!best.is_valid_ || sample.us_ < best.us_)
+        best = sample;
+}
+
+/*!
+ * Best measurement of a named build phase.
+ */
+struct PhaseSample
+{
+    const char *name_;
+    Sample best_;
+};
+
+/* phases are collected without allocating while a model is being built */
+static constexpr size_t MAX_PHASES = 32;
+
+static nlohmann::json
+build_model(const StaticModels::DeviceModelsDatabase &database,
+            const std::string &device_id, unsigned int repeat)
+{
+    nlohmann::json result;
+    result["id"] = device_id;
+
+    std::array<PhaseSample, MAX_PHASES> phases;
+    size_t number_of_phases = 0;
+    Sample total;
+
+    for(unsigned int i = 0; i < repeat; ++i)
+    {
+        try
+        {
+            const auto &definition(database.get_device_model_definition(device_id));
+            size_t phase_index = 0;
+            Probe phase_probe;
+
+            /* set up everything the tool needs before measuring, so that
+             * only the allocations done by building the model are counted */
+            const StaticModels::DeviceModel::BuildPhaseFn phase_done(
+                [&phases, &number_of_phases, &phase_index, &phase_probe]
+                (const char *phase)
+                {
+                    const auto sample(phase_probe.take());
+
+                    if(phase_index < MAX_PHASES)
+                    {
+                        if(phase_index >= number_of_phases)
+                        {
+                            phases[phase_index].name_ = phase;
+                            number_of_phases = phase_index + 1;
+                        }
+
+                        keep_best(phases[phase_index].best_, sample);
+                    }
+
+                    ++phase_index;
+                    phase_probe.reset();
+                });
+            std::string name(device_id);
+
+            phase_probe.reset();
+            Probe total_probe;
+
+            const auto model(StaticModels::DeviceModel::mk_model(
+                                std::move(name), definition, phase_done));
+
+            const auto sample(total_probe.take());
+
+            if(i == 0)
+            {
+                const auto &graph(model.get_signal_path_graph());
+                size_t number_of_elements = 0;
+                model.for_each_element(
+                    [&number_of_elements] (const auto &) { ++number_of_elements; });
+
+                result["elements"] = number_of_elements;
+                result["signal_path_elements"] = graph.get_number_of_elements();
+                result["signal_path_edges"] = graph.get_number_of_edges();
+                result["usb_connectors"] = model.get_usb_connectors().size();
+            }
+
+            /* the model itself is freed after taking the sample */
+            keep_best(total, sample);
+        }
+        catch(const std::exception &e)
+        {
+            result["ok"] = false;
+            result["error"] = e.what();
+            return result;
+        }
+    }
+
+    result["ok"] = true;
+    result["total"] = total.json();
+
+    for(size_t i = 0; i < number_of_phases; ++i)
+    {
+        auto phase(phases[i].best_.json());
+        phase["phase"] = phases[i].name_;
+        result["phases"].push_back(std::move(phase));
+    }
+
+    return result;
+}
+
+/* random selector states generated per model, duplicates are dropped */
+static constexpr size_t BENCH_STATES = 64;
+
+/* operations per measurement */
+static constexpr size_t BENCH_OPERATIONS = 20000;
+
+/*!
+ * Run \p op \p ops times, \p repeat times in a row.
+ *
+ * \returns
+ *     Best time per operation in nanoseconds, and the number of allocations
+ *     per operation in that run.
+ */
+template <typename OpFn>
+static nlohmann::json measure(unsigned int repeat, size_t ops, const OpFn &op)
+{
+    long long best_ns = -1;
+    double best_allocations = 0.0;
+
+    for(unsigned int r = 0; r < repeat; ++r)
+    {
+        const size_t count = allocations_count;
+        const auto start(std::chrono::steady_clock::now());
+
+        for(size_t i = 0; i < ops; ++i)
+            op(i);
+
+        const auto ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+        if(best_ns < 0 || ns < best_ns)
+        {
+            best_ns = ns;
+            best_allocations = double(allocations_count - count) / ops;
+        }
+    }
+
+    nlohmann::json result;
+    result["ns"] = best_ns / static_cast<long long>(ops);
+    result["allocations"] = best_allocations;
+    return result;
+}
+
+/*!
+ * Measure signal path queries on a built model.
+ *
+ * Selector states are generated from a fixed seed, so that results are
+ * comparable between runs and between revisions. The distinct states are
+ * cycled through, so that queries following a state change are never
+ * answered from the tracker's cache of active paths if there are more
+ * distinct states than the cache holds (16).
+ */
+static nlohmann::json bench_model(const StaticModels::DeviceModel &model,
+                                  unsigned int repeat)
+{
+    using StaticModels::SignalPaths::Selector;
+    using StaticModels::SignalPaths::SelectorHandle;
+
+    const auto &appliance(model.get_signal_path_graph());
+    const auto &graph(appliance.get_graph());
+    const size_t number_of_switches = appliance.get_number_of_switching_elements();
+
+    std::vector<uint32_t> choices;
+    for(size_t h = 0; h < number_of_switches; ++h)
+    {
+        const auto *sw = appliance.lookup_switching_element(SelectorHandle(h));
+        uint32_t n = 0;
+        while(sw->is_selector_in_range(Selector(n)))
+            ++n;
+        choices.push_back(n);
+    }
+
+    std::vector<const StaticModels::SignalPaths::PathElement *> sinks;
+    for(uint32_t i = 0; i < graph.size(); ++i)
+        if(graph.is_sink(i))
+            sinks.push_back(&graph.get_element(i));
+
+    std::mt19937 rng(1);
+    std::vector<std::vector<uint32_t>> states(BENCH_STATES);
+    for(auto &state : states)
+        for(const auto &n : choices)
+            state.push_back(n > 0 ? rng() % n : 0);
+
+    std::sort(states.begin(), states.end());
+    states.erase(std::unique(states.begin(), states.end()), states.end());
+    std::shuffle(states.begin(), states.end(), rng);
+
+    ModelCompliant::SignalPathTracker tracker(appliance);
+    size_t visited = 0;
+
+    const auto set_state =
+        [&tracker, &states] (size_t i)
+        {
+            const auto &state(states[i % states.size()]);
+            for(size_t h = 0; h < state.size(); ++h)
+                tracker.select(SelectorHandle(h), Selector(state[h]));
+        };
+
+    const auto count_path =
+        [&visited] (const auto &path) { visited += path.size(); return true; };
+
+    nlohmann::json result;
+    result["switching_elements"] = number_of_switches;
+    result["sinks"] = sinks.size();
+    result["distinct_states"] = states.size();
+
+    /* all selectors of one state are set per operation */
+    result["select_state"] = measure(repeat, BENCH_OPERATIONS, set_state);
+
+    set_state(0);
+    tracker.enumerate_active_signal_paths(count_path);
+    result["enumerate_cached"] =
+        measure(repeat, BENCH_OPERATIONS,
+                [&tracker, &count_path] (size_t)
+                { tracker.enumerate_active_signal_paths(count_path); });
+
+    result["select_state_and_enumerate"] =
+        measure(repeat, BENCH_OPERATIONS,
+                [&tracker, &set_state, &count_path] (size_t i)
+                {
+                    set_state(i);
+                    tracker.enumerate_active_signal_paths(count_path);
+                });
+
+    result["select_state_and_paths_to_sinks"] =
+        measure(repeat, BENCH_OPERATIONS,
+                [&tracker, &set_state, &count_path, &sinks] (size_t i)
+                {
+                    set_state(i);
+                    for(const auto *sink : sinks)
+                        tracker.enumerate_active_signal_paths_to_sink(*sink, count_path);
+                });
+
+    result["select_state_and_signal_types"] =
+        measure(repeat, BENCH_OPERATIONS,
+                [&tracker, &set_state, &sinks, &visited] (size_t i)
+                {
+                    set_state(i);
+                    for(const auto *sink : sinks)
+                        visited += tracker.get_signal_types(*sink);
+                });
+
+    /* keeps the queries from being optimized away */
+    result["checksum"] = visited;
+
+    return result;
+}
+
+static nlohmann::json
+bench_model(const StaticModels::DeviceModelsDatabase &database,
+            const std::string &device_id, unsigned int repeat)
+{
+    nlohmann::json result;
+    result["id"] = device_id;
+
+    try
+    {
+        const auto model(StaticModels::DeviceModel::mk_model(
+            std::string(device_id),
+            database.get_device_model_definition(device_id)));
+        result["bench"] = bench_model(model, repeat);
+    }
+    catch(const std::exception &e)
+    {
+        result["ok"] = false;
+        result["error"] = e.what();
+        return result;
+    }
+
+    result["ok"] = true;
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    Parameters parameters;
+    const int ret = process_command_line(argc, argv, parameters);
+
+    if(ret == -1)
+        return EXIT_FAILURE;
+    else if(ret == 1)
+    {
+        usage(argv[0]);
+        return EXIT_SUCCESS;
+    }
+
+    msg_enable_syslog(false);
+    msg_set_verbose_level(MESSAGE_LEVEL_QUIET);
+
+    nlohmann::json report;
+    report["models_file"] = parameters.device_models_file_;
+
+    StaticModels::DeviceModelsDatabase database;
+    Probe probe;
+
+    if(!database.load(parameters.device_models_file_))
+    {
+        report["ok"] = false;
+        report["error"] = "Failed loading models file";
+        std::cout << report.dump(parameters.pretty_ ? 4 : -1) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    report["load"] = probe.take().json();
+
+    try
+    {
+        database.flatten();
+    }
+    catch(const std::exception &e)
+    {
+        report["ok"] = false;
+        report["error"] = e.what();
+        std::cout << report.dump(parameters.pretty_ ? 4 : -1) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    report["flatten"] = probe.take().json();
+
+    std::vector<std::string> all_ids;
+    database.for_each_device_id(
+        [&all_ids] (const std::string &device_id) { all_ids.push_back(device_id); });
+
+    if(parameters.device_ids_.empty())
+        parameters.device_ids_ = all_ids;
+
+    size_t failed = 0;
+    report["models"] = nlohmann::json::array();
+
+    /* identical definitions are built only once at runtime, so they are
+     * reported as aliases here; definitions with equal hashes are compared
+     * in full, just like the model cache tells them apart */
+    std::unordered_multimap<size_t, std::pair<std::string, bool>> built_by_hash;
+
+    for(const auto &device_id : parameters.device_ids_)
+    {
+        nlohmann::json model_report;
+
+        if(std::find(all_ids.begin(), all_ids.end(), device_id) != all_ids.end())
+        {
+            const auto &definition(database.get_device_model_definition(device_id));
+            const auto definition_hash(std::hash<nlohmann::json>{}(definition));
+            const auto candidates(built_by_hash.equal_range(definition_hash));
+            const auto identical(
+                std::find_if(candidates.first, candidates.second,
+                    [&database, &definition] (const auto &it)
+                    {
+                        return database.get_device_model_definition(it.second.first) ==
+                               definition;
+                    }));
+
+            if(identical == candidates.second)
+            {
+                model_report = parameters.bench_
+                    ? bench_model(database, device_id, parameters.repeat_)
+                    : build_model(database, device_id, parameters.repeat_);
+                built_by_hash.emplace(definition_hash,
+                                      std::make_pair(device_id,
+                                                     model_report["ok"].get<bool>()));
+            }
+            else
+            {
+                model_report["id"] = device_id;
+                model_report["ok"] = identical->second.second;
+                model_report["identical_to"] = identical->second.first;
+            }
+        }
+        else
+        {
+            model_report["id"] = device_id;
+            model_report["ok"] = false;
+            model_report["error"] = "Unknown device ID";
+        }
+
+        if(!model_report["ok"].get<bool>())
+            ++failed;
+
+        report["models"].push_back(std::move(model_report));
+    }
+
+    report["ok"] = failed == 0;
+    report["failed"] = failed;
+    report["distinct_models"] = built_by_hash.size();
+
+    std::cout << report.dump(parameters.pretty_ ? 4 : -1) << std::endl;
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+ssize_t (*os_read)(int fd, void *dest, size_t count) = read;
+ssize_t (*os_write)(int fd, const void *buf, size_t count) = write;
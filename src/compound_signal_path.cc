@@ -57,6 +57,13 @@ bool ModelCompliant::CompoundSignalPathTracker::enumerate_compound_signal_paths(
 
             extend_path(partial);
 
+            /* types from upstream appliances remain in effect if there are
+             * no types declared for this part of the path */
+            auto types(dev_ctx.get_signal_types(partial));
+            const bool have_types = !types.empty();
+            if(have_types)
+                std::swap(types, current_path_.signal_types_);
+
             bool has_connected_device = false;
             const auto &sink_elem(*partial.back().first);
 
@@ -72,7 +79,12 @@ bool ModelCompliant::CompoundSignalPathTracker::enumerate_compound_signal_paths(
                 }
             );
 
-            return has_connected_device || (*fn_)(current_path_);
+            const bool result = has_connected_device || (*fn_)(current_path_);
+
+            if(have_types)
+                std::swap(types, current_path_.signal_types_);
+
+            return result;
         }
     );
 
@@ -81,3 +93,102 @@ bool ModelCompliant::CompoundSignalPathTracker::enumerate_compound_signal_paths(
 
     return result;
 }
+
+/*!
+ * Enumerate compound audio paths ending in given sink of given appliance.
+ *
+ * This is the reverse of #enumerate_compound_signal_paths(). Starting at the
+ * sink, the active paths within each appliance are followed upstream to the
+ * appliances connected to their inputs, so that only appliances on the way
+ * to the sink are visited at all. Paths are reported from their sources to
+ * the sink. A path starts at a source of the first appliance which has no
+ * other appliance connected to the input the path begins with.
+ *
+ * \returns
+ *     False if \p fn has aborted the enumeration, true otherwise.
+ */
+bool ModelCompliant::CompoundSignalPathTracker::enumerate_compound_signal_paths_to_sink(
+        const std::string &device_instance_name, const std::string &sink_name,
+        const EnumerateCallbackFn &fn)
+{
+    incoming_connections_.clear();
+    settings_iterator_.for_each_connection(
+        [this]
+        (const std::string &source_device, const std::string &sink,
+         const std::string &target_device, const std::string &input_name)
+        {
+            incoming_connections_[{target_device, input_name}]
+                .emplace_back(source_device, sink);
+        });
+
+    fn_ = &fn;
+    const auto result = enumerate_upstream(device_instance_name, sink_name);
+    fn_ = nullptr;
+    upstream_segments_.clear();
+    return result;
+}
+
+bool ModelCompliant::CompoundSignalPathTracker::enumerate_upstream(
+        const std::string &device_instance_name, const std::string &sink_name)
+{
+    const auto &dev_ctx(settings_iterator_.with_device(device_instance_name));
+    if(dev_ctx.get_model() == nullptr)
+        return true;
+
+    return dev_ctx.for_each_signal_path_to_sink(
+        sink_name,
+        [this, &device_instance_name]
+        (const SignalPathTracker::ActivePath &partial)
+        {
+            upstream_segments_.emplace_back(&device_instance_name, &partial);
+
+            const auto conns(incoming_connections_.find(
+                    {device_instance_name, partial.front().first->get_name()}));
+            bool result = true;
+
+            if(conns == incoming_connections_.end())
+                result = report_upstream_path();
+            else
+            {
+                for(const auto &conn : conns->second)
+                {
+                    if(!enumerate_upstream(conn.first, conn.second))
+                    {
+                        result = false;
+                        break;
+                    }
+                }
+            }
+
+            upstream_segments_.pop_back();
+            return result;
+        });
+}
+
+bool ModelCompliant::CompoundSignalPathTracker::report_upstream_path()
+{
+    current_path_.clear();
+    device_name_store_.clear();
+
+    for(auto it = upstream_segments_.rbegin(); it != upstream_segments_.rend(); ++it)
+    {
+        device_name_store_.emplace_back(*it->first, current_path_.path_.size());
+        extend_path(*it->second);
+    }
+
+    /* types from upstream appliances remain in effect if there are no types
+     * declared for the downstream parts of the path */
+    for(const auto &seg : upstream_segments_)
+    {
+        auto types(settings_iterator_.with_device(*seg.first)
+                   .get_signal_types(*seg.second));
+
+        if(!types.empty())
+        {
+            current_path_.signal_types_ = std::move(types);
+            break;
+        }
+    }
+
+    return (*fn_)(current_path_);
+}
@@ -25,6 +25,8 @@
 #include "signal_path_tracker.hh"
 #include "configstore_iter.hh"
 
+#include <map>
+
 namespace ModelCompliant
 {
 
@@ -38,6 +40,7 @@ class CompoundSignalPath
   private:
     std::vector<std::pair<size_t, const StaticModels::SignalPaths::PathElement *>> path_;
     std::vector<std::pair<std::string, size_t>> device_name_store_;
+    std::vector<std::string> signal_types_;
 
   public:
     CompoundSignalPath(const CompoundSignalPath &) = delete;
@@ -56,8 +59,17 @@ class CompoundSignalPath
     {
         path_.clear();
         device_name_store_.clear();
+        signal_types_.clear();
     }
 
+    /*!
+     * Signal types arriving at the end of the path.
+     *
+     * These are the types determined in the last appliance on the path which
+     * has any signal types declared in its model.
+     */
+    const std::vector<std::string> &get_signal_types() const { return signal_types_; }
+
     bool operator==(const CompoundSignalPath &other) const
     {
         if(path_.size() == other.path_.size())
@@ -89,6 +101,14 @@ class CompoundSignalPathTracker
     CompoundSignalPath current_path_;
     std::vector<std::pair<std::string, size_t>> device_name_store_;
 
+    /* source device and sink for each target device and input */
+    std::map<std::pair<std::string, std::string>,
+             std::vector<std::pair<std::string, std::string>>> incoming_connections_;
+
+    /* partial paths collected while walking upstream, from the sink on */
+    std::vector<std::pair<const std::string *,
+                          const SignalPathTracker::ActivePath *>> upstream_segments_;
+
   public:
     CompoundSignalPathTracker(const CompoundSignalPathTracker &) = delete;
     CompoundSignalPathTracker(CompoundSignalPathTracker &&) = default;
@@ -115,10 +135,16 @@ class CompoundSignalPathTracker
 
     bool enumerate_compound_signal_paths(const std::string &device_instance_name,
                                          const std::string &input_name_filter);
+    bool enumerate_upstream(const std::string &device_instance_name,
+                            const std::string &sink_name);
+    bool report_upstream_path();
 
   public:
     bool enumerate_compound_signal_paths(const std::string &device_instance_name,
                                          const EnumerateCallbackFn &fn);
+    bool enumerate_compound_signal_paths_to_sink(const std::string &device_instance_name,
+                                                 const std::string &sink_name,
+                                                 const EnumerateCallbackFn &fn);
 
     const std::string &map_path_index_to_device_name(size_t idx) const
     {
@@ -130,6 +156,7 @@ class CompoundSignalPathTracker
         CompoundSignalPath dest;
         dest.path_ = src.path_;
         dest.device_name_store_ = device_name_store_;
+        dest.signal_types_ = src.signal_types_;
         return dest;
     }
 };
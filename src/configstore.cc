@@ -33,6 +33,7 @@
 #include "model_parsing_utils.hh"
 #include "messages.h"
 
+#include <cmath>
 #include <list>
 #include <string>
 #include <unordered_map>
@@ -322,6 +323,13 @@ class ReportedElement
         old_values = std::move(values_);
     }
 
+    void for_each_value(const std::function<void(const std::string &parameter_name,
+                                                 ConfigStore::Value &value)> &apply)
+    {
+        for(auto &it : values_)
+            apply(it.first, it.second);
+    }
+
     const auto &get_values() const
     {
         // cppcheck-suppress accessMoved
@@ -342,7 +350,7 @@ class Device
     const std::string device_id_;
 
   private:
-    const StaticModels::DeviceModel *const model_;
+    const StaticModels::DeviceModel *model_;
     std::unique_ptr<ModelCompliant::SignalPathTracker> current_signal_path_;
 
     std::unordered_map<std::string, ReportedElement> elements_;
@@ -379,19 +387,29 @@ class Device
                 const std::string &type_code, const nlohmann::json &value,
                 ConfigStore::Value &old_value)
     {
+        return set_value(element_id, element_parameter_name,
+                         ConfigStore::Value(type_code, value), old_value);
+    }
+
+    const ConfigStore::Value &set_value(
+                const std::string &element_id,
+                const std::string &element_parameter_name,
+                ConfigStore::Value &&value, ConfigStore::Value &old_value)
+    {
+        const auto *ctrl(model_ != nullptr
+                         ? model_->get_control_by_name(element_id,
+                                                       element_parameter_name)
+                         : nullptr);
+
+        if(ctrl != nullptr)
+            ctrl->resolve_value(value);
+
         const auto &new_value(get_element(element_id)
                               .set_value(element_parameter_name, old_value,
-                                         ConfigStore::Value(type_code,
-                                                            nlohmann::json(value))));
+                                         std::move(value)));
 
-        if(current_signal_path_ != nullptr)
-        {
-            const auto sel(model_->to_selector_index(element_id,
-                                                     element_parameter_name,
-                                                     new_value));
-            if(sel.is_valid())
-                current_signal_path_->select(element_id, sel);
-        }
+        if(current_signal_path_ != nullptr && ctrl != nullptr)
+            select(*ctrl, element_id, element_parameter_name, new_value);
 
         return new_value;
     }
@@ -402,9 +420,8 @@ class Device
     {
         get_element(element_id).unset_value(element_parameter_name, old_value);
 
-        if(current_signal_path_ != nullptr &&
-           model_->has_selector(element_id, element_parameter_name))
-            current_signal_path_->floating(element_id);
+        if(current_signal_path_ != nullptr)
+            floating(element_id, element_parameter_name);
     }
 
     void unset_values(const std::string &element_id,
@@ -412,20 +429,20 @@ class Device
     {
         get_element(element_id).unset_values(old_values);
 
-        if(current_signal_path_ != nullptr)
-            if(std::any_of(old_values.begin(), old_values.end(),
-                    [this, &element_id] (const auto &v)
-                    { return model_->has_selector(element_id, v.first); }))
-            {
-                current_signal_path_->floating(element_id);
+        if(current_signal_path_ == nullptr)
+            return;
+
+        for(const auto &v : old_values)
+            if(floating(element_id, v.first))
                 return;
-            }
     }
 
     void add_connection(const std::string &sink_name,
                         const std::string &target_dev,
                         const std::string &target_conn);
 
+    void reattach_model(const StaticModels::DeviceModel *model);
+
     const auto *get_model() const { return model_; }
     const auto &get_elements() const { return elements_; }
     const auto &get_outgoing_connections() const { return outgoing_connections_; }
@@ -450,6 +467,32 @@ class Device
   private:
     /* get or insert element by name */
     ReportedElement &get_element(const std::string &element_id);
+
+    /* forward value of a selector control to the signal path tracker */
+    void select(const StaticModels::Elements::Control &ctrl,
+                const std::string &element_id, const std::string &control_id,
+                const ConfigStore::Value &value)
+    {
+        const auto handle(model_->get_selector_handle(element_id, control_id));
+        if(!handle.is_valid())
+            return;
+
+        const auto sel(model_->to_selector_index(ctrl, element_id, control_id,
+                                                 value));
+        if(sel.is_valid())
+            current_signal_path_->select(handle, sel);
+    }
+
+    /* let switching element float if given control is its selector */
+    bool floating(const std::string &element_id, const std::string &control_id)
+    {
+        const auto handle(model_->get_selector_handle(element_id, control_id));
+        if(!handle.is_valid())
+            return false;
+
+        current_signal_path_->floating(handle);
+        return true;
+    }
 };
 
 /*!
@@ -459,35 +502,42 @@ class ConfigStore::Settings::Impl
 {
   private:
     /* models */
-    const StaticModels::DeviceModelsDatabase &models_database_;
-    std::unordered_map<std::string, std::unique_ptr<StaticModels::DeviceModel>> models_;
+    StaticModels::DeviceModelCache &models_;
     const StaticModels::DeviceModel *root_appliance_model_;
 
     /* instances */
     std::unordered_map<std::string, Device> devices_;
     std::unique_ptr<ChangeLog> log_;
 
+    /* true if the data are kept only as reference for the next full update */
+    bool is_stale_;
+
   public:
     Impl(const Impl &) = delete;
     Impl(Impl &&) = default;
     Impl &operator=(const Impl &) = delete;
     Impl &operator=(Impl &&) = default;
 
-    explicit Impl(const StaticModels::DeviceModelsDatabase &models_database):
-        models_database_(models_database),
-        root_appliance_model_(nullptr)
+    explicit Impl(StaticModels::DeviceModelCache &models):
+        models_(models),
+        root_appliance_model_(nullptr),
+        is_stale_(false)
     {}
 
     /*
      * Create new object from old one, ditching most the old one's data.
-     * This is sort of a lossy move constructor.
+     * This is sort of a lossy move constructor. The device models are not
+     * owned by us, so they survive.
      */
     static std::unique_ptr<Impl> make_fresh(std::unique_ptr<Impl> old)
     {
-        return std::make_unique<Impl>(old->models_database_);
+        return std::make_unique<Impl>(old->models_);
     }
 
-    void update(const nlohmann::json &j);
+    void invalidate() { is_stale_ = true; }
+    bool is_stale() const { return is_stale_; }
+    void update(const nlohmann::json &j, Settings::UpdateMode mode);
+    bool reattach_models();
     nlohmann::json json() const;
 
     bool extract_changes(Changes &changes)
@@ -524,7 +574,19 @@ class ConfigStore::Settings::Impl
         }
     }
 
+    void for_each_connection(const SettingsIterator::ConnectionFn &apply) const
+    {
+        for(const auto &dev : devices_)
+            for(const auto &conn : dev.second.get_outgoing_connections())
+                for(const auto &input_name : conn.second)
+                    apply(dev.second.name_, conn.first.first,
+                          conn.first.second, input_name);
+    }
+
   private:
+    void apply_changes(const nlohmann::json &j);
+    void apply_differences(const Impl &staged);
+    void drop_instance(const std::string &name);
     void add_instance(std::string &&name, std::string &&device_id);
     bool remove_instance(const std::string &name, bool must_exist);
     void clear_instances();
@@ -538,7 +600,6 @@ class ConfigStore::Settings::Impl
     void remove_outgoing_connections(const std::string &from);
     void remove_ingoing_connections(const std::string &to);
     void remove_all_connections();
-    const StaticModels::DeviceModel *get_device_model(const std::string &name);
 };
 
 ConfigStore::ValueType
@@ -647,6 +708,263 @@ bool ConfigStore::type_check(const nlohmann::json &value, ValueType vt,
     return false;
 }
 
+ConfigStore::Value
+ConfigStore::Value::mk_signed(ValueType vtype, int64_t value)
+{
+    Value v(vtype);
+
+    switch(vtype)
+    {
+      case ValueType::VT_INT8:
+      case ValueType::VT_INT16:
+      case ValueType::VT_INT32:
+      case ValueType::VT_INT64:
+        v.set_from_json(value);
+        return v;
+
+      case ValueType::VT_UINT8:
+      case ValueType::VT_UINT16:
+      case ValueType::VT_UINT32:
+      case ValueType::VT_UINT64:
+        if(value >= 0)
+        {
+            v.set_from_json(uint64_t(value));
+            return v;
+        }
+
+        break;
+
+      case ValueType::VT_DOUBLE:
+      case ValueType::VT_TA_FIX_POINT:
+        v.set_from_json(double(value));
+        return v;
+
+      case ValueType::VT_VOID:
+      case ValueType::VT_ASCIIZ:
+      case ValueType::VT_BOOL:
+        break;
+    }
+
+    Error()
+        << "mismatch between type code \"" << type_to_type_code(vtype) <<
+        "\" and value \"" << value << "\"";
+}
+
+ConfigStore::Value
+ConfigStore::Value::mk_unsigned(ValueType vtype, uint64_t value)
+{
+    if(value > uint64_t(std::numeric_limits<int64_t>::max()))
+    {
+        Value v(vtype);
+        v.set_from_json(value);
+        return v;
+    }
+
+    return mk_signed(vtype, int64_t(value));
+}
+
+ConfigStore::Value
+ConfigStore::Value::mk_double(ValueType vtype, double value)
+{
+    Value v(vtype);
+    v.set_from_json(value);
+    return v;
+}
+
+ConfigStore::Value ConfigStore::Value::mk_fix_point(int64_t native)
+{
+    if(!FixPoint::is_in_range(fix_point_to_double(native)))
+        Error() << "fixed-point value " << native << "/" << FIX_POINT_SCALE
+                << " out of range";
+
+    Value v(ValueType::VT_TA_FIX_POINT);
+    v.data_.signed_ = native;
+    return v;
+}
+
+int64_t ConfigStore::Value::fix_point_from_double(double value)
+{
+    if(!FixPoint::is_in_range(value))
+        Error() << "value " << value << " out of fixed-point range";
+
+    return std::llround(value * FIX_POINT_SCALE);
+}
+
+void ConfigStore::Value::set_from_json(const nlohmann::json &value)
+{
+    type_check(value, type_, true);
+
+    switch(type_)
+    {
+      case ValueType::VT_VOID:
+        break;
+
+      case ValueType::VT_ASCIIZ:
+        set_string(value.get_ref<const std::string &>());
+        break;
+
+      case ValueType::VT_BOOL:
+        data_.bool_ = value.get<bool>();
+        break;
+
+      case ValueType::VT_INT8:
+      case ValueType::VT_INT16:
+      case ValueType::VT_INT32:
+      case ValueType::VT_INT64:
+        data_.signed_ = value.get<int64_t>();
+        break;
+
+      case ValueType::VT_UINT8:
+      case ValueType::VT_UINT16:
+      case ValueType::VT_UINT32:
+      case ValueType::VT_UINT64:
+        data_.unsigned_ = value.get<uint64_t>();
+        break;
+
+      case ValueType::VT_DOUBLE:
+        data_.double_ = value.get<double>();
+        break;
+
+      case ValueType::VT_TA_FIX_POINT:
+        data_.signed_ = fix_point_from_double(value.get<double>());
+        break;
+    }
+}
+
+/*
+ * Doubles with integral values are emitted as integers so that JSON output
+ * looks the same as the JSON input it was parsed from in most cases.
+ */
+static nlohmann::json double_to_json(double value)
+{
+    if(std::trunc(value) == value &&
+       value >= double(std::numeric_limits<int32_t>::min()) &&
+       value <= double(std::numeric_limits<int32_t>::max()))
+        return int64_t(value);
+
+    return value;
+}
+
+nlohmann::json ConfigStore::Value::get_value() const
+{
+    switch(type_)
+    {
+      case ValueType::VT_VOID:
+        break;
+
+      case ValueType::VT_ASCIIZ:
+        return std::string(get_string());
+
+      case ValueType::VT_BOOL:
+        return data_.bool_;
+
+      case ValueType::VT_INT8:
+      case ValueType::VT_INT16:
+      case ValueType::VT_INT32:
+      case ValueType::VT_INT64:
+        return data_.signed_;
+
+      case ValueType::VT_UINT8:
+      case ValueType::VT_UINT16:
+      case ValueType::VT_UINT32:
+      case ValueType::VT_UINT64:
+        return data_.unsigned_;
+
+      case ValueType::VT_DOUBLE:
+        return double_to_json(data_.double_);
+
+      case ValueType::VT_TA_FIX_POINT:
+        return double_to_json(fix_point_to_double(data_.signed_));
+    }
+
+    return nullptr;
+}
+
+nlohmann::json ConfigStore::Value::get_as(ValueType vt) const
+{
+    switch(vt)
+    {
+      case ValueType::VT_VOID:
+        break;
+
+      case ValueType::VT_ASCIIZ:
+        return std::string(get_string());
+
+      case ValueType::VT_BOOL:
+        return get_bool();
+
+      case ValueType::VT_INT8:
+      case ValueType::VT_INT16:
+      case ValueType::VT_INT32:
+      case ValueType::VT_INT64:
+        return get_int64();
+
+      case ValueType::VT_UINT8:
+      case ValueType::VT_UINT16:
+      case ValueType::VT_UINT32:
+      case ValueType::VT_UINT64:
+        return get_uint64();
+
+      case ValueType::VT_DOUBLE:
+        return get_double();
+
+      case ValueType::VT_TA_FIX_POINT:
+        return fix_point_to_double(get_fix_point_native());
+    }
+
+    return nullptr;
+}
+
+template <typename T>
+static inline int three_way_compare(const T &a, const T &b)
+{
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+int ConfigStore::Value::compare(const Value &other) const
+{
+    msg_log_assert(type_ == other.type_);
+
+    switch(type_)
+    {
+      case ValueType::VT_VOID:
+        break;
+
+      case ValueType::VT_ASCIIZ:
+        return get_string().compare(other.get_string());
+
+      case ValueType::VT_BOOL:
+        return three_way_compare(data_.bool_, other.data_.bool_);
+
+      case ValueType::VT_INT8:
+      case ValueType::VT_INT16:
+      case ValueType::VT_INT32:
+      case ValueType::VT_INT64:
+        return three_way_compare(data_.signed_, other.data_.signed_);
+
+      case ValueType::VT_UINT8:
+      case ValueType::VT_UINT16:
+      case ValueType::VT_UINT32:
+      case ValueType::VT_UINT64:
+        return three_way_compare(data_.unsigned_, other.data_.unsigned_);
+
+      case ValueType::VT_DOUBLE:
+        return three_way_compare(data_.double_, other.data_.double_);
+
+      case ValueType::VT_TA_FIX_POINT:
+        return three_way_compare(data_.signed_, other.data_.signed_);
+    }
+
+    return 0;
+}
+
+void ConfigStore::Value::type_error(const char *expected) const
+{
+    Error()
+        << "value of type code \"" << get_type_code() <<
+        "\" accessed as " << expected;
+}
+
 void Device::add_connection(const std::string &sink_name,
                             const std::string &target_dev,
                             const std::string &target_conn)
@@ -797,11 +1115,121 @@ ReportedElement &Device::get_element(const std::string &element_id)
     return *static_cast<ReportedElement *>(nullptr);
 }
 
-void ConfigStore::Settings::Impl::update(const nlohmann::json &j)
+/*!
+ * Switch over to another model for the same device ID.
+ *
+ * The signal path tracker is recreated for the new model, and all stored
+ * values are resolved against the new model's controls again. Selector
+ * states are restored for all elements which still exist in the new model
+ * under the same name, all other selectors end up floating.
+ */
+void Device::reattach_model(const StaticModels::DeviceModel *model)
+{
+    model_ = model;
+    current_signal_path_ =
+        model_ != nullptr
+        ? std::make_unique<ModelCompliant::SignalPathTracker>(model_->get_signal_path_graph())
+        : nullptr;
+
+    for(auto &elem : elements_)
+        elem.second.for_each_value(
+            [this, &element_id = elem.first]
+            (const std::string &parameter_name, ConfigStore::Value &value)
+            {
+                /* do not keep references into the old model */
+                if(value.is_of_type(ConfigStore::ValueType::VT_ASCIIZ))
+                    value = ConfigStore::Value::mk_string(std::string(value.get_string()));
+
+                if(model_ == nullptr)
+                    return;
+
+                const auto *ctrl(model_->get_control_by_name(element_id,
+                                                             parameter_name));
+                if(ctrl == nullptr)
+                    return;
+
+                ctrl->resolve_value(value);
+
+                if(current_signal_path_ != nullptr)
+                    select(*ctrl, element_id, parameter_name, value);
+            });
+}
+
+static bool is_full_state_declaration(const nlohmann::json &j)
+{
+    const auto &changes(j.at("audio_path_changes"));
+    return !changes.empty() && changes[0].at("op") == "clear_instances";
+}
+
+void ConfigStore::Settings::Impl::update(const nlohmann::json &j,
+                                         Settings::UpdateMode mode)
 {
+    if(mode == Settings::UpdateMode::DETECT_FULL_STATE)
+        mode = is_full_state_declaration(j)
+            ? Settings::UpdateMode::REPLACE_ALL
+            : Settings::UpdateMode::INCREMENTAL;
+
+    /* incremental changes cannot be applied to outdated data */
+    if(is_stale_ && mode == Settings::UpdateMode::INCREMENTAL)
+    {
+        devices_.clear();
+        log_ = nullptr;
+        root_appliance_model_ = nullptr;
+        is_stale_ = false;
+    }
+
     if(log_ == nullptr)
         log_ = std::make_unique<ChangeLog>();
 
+    switch(mode)
+    {
+      case Settings::UpdateMode::INCREMENTAL:
+        apply_changes(j);
+        break;
+
+      case Settings::UpdateMode::REPLACE_ALL:
+        {
+            Impl staged(models_);
+            staged.log_ = std::make_unique<ChangeLog>();
+            staged.apply_changes(j);
+            apply_differences(staged);
+
+            /* data remains stale if the declaration could not be applied */
+            is_stale_ = false;
+        }
+
+        break;
+
+      case Settings::UpdateMode::DETECT_FULL_STATE:
+        MSG_BUG("Unresolved update mode");
+        break;
+    }
+}
+
+bool ConfigStore::Settings::Impl::reattach_models()
+{
+    bool changed = false;
+
+    for(auto &it : devices_)
+    {
+        auto &dev(it.second);
+        const auto *dm = models_.get_device_model(dev.device_id_);
+
+        if(dm == dev.get_model())
+            continue;
+
+        dev.reattach_model(dm);
+        changed = true;
+
+        if(dev.name_ == "self")
+            root_appliance_model_ = dm;
+    }
+
+    return changed;
+}
+
+void ConfigStore::Settings::Impl::apply_changes(const nlohmann::json &j)
+{
     for(const auto &change : j.at("audio_path_changes"))
     {
         const auto &op(change.at("op").get<std::string>());
@@ -857,7 +1285,7 @@ void ConfigStore::Settings::Impl::add_instance(std::string &&name,
 
     log_->add_device(std::string(name));
 
-    const auto *dm = get_device_model(std::string(device_id));
+    const auto *dm = models_.get_device_model(device_id);
 
     if(name == "self")
         root_appliance_model_ = dm;
@@ -916,6 +1344,146 @@ void ConfigStore::Settings::Impl::clear_instances()
     root_appliance_model_ = nullptr;
 }
 
+/*
+ * Remove instance and everything connected to it, log only what actually
+ * belonged to the instance.
+ */
+void ConfigStore::Settings::Impl::drop_instance(const std::string &name)
+{
+    auto dev(devices_.find(name));
+    msg_log_assert(dev != devices_.end());
+
+    for(auto &d : devices_)
+        d.second.remove_connections_with_target(name, *log_);
+
+    for(const auto &elem : dev->second.get_elements())
+        for(const auto &val : elem.second.get_values())
+            log_->set_value(name + '.' + elem.first + '.' + val.first,
+                            ConfigStore::Value(val.second), ConfigStore::Value());
+
+    dev->second.remove_connections(*log_);
+    devices_.erase(dev);
+    log_->remove_device(std::string(name));
+
+    if(name == "self")
+        root_appliance_model_ = nullptr;
+}
+
+/*
+ * Turn this object into a copy of the staged one by applying only the
+ * differences between both.
+ */
+void ConfigStore::Settings::Impl::apply_differences(const Impl &staged)
+{
+    /* instances which are gone or which have been replaced by another model */
+    std::vector<std::string> names;
+
+    for(const auto &dev : devices_)
+    {
+        const auto it(staged.devices_.find(dev.first));
+        if(it == staged.devices_.end() ||
+           it->second.device_id_ != dev.second.device_id_)
+            names.push_back(dev.first);
+    }
+
+    for(const auto &name : names)
+        drop_instance(name);
+
+    /* new instances */
+    for(const auto &dev : staged.devices_)
+        if(devices_.find(dev.first) == devices_.end())
+            add_instance(std::string(dev.first),
+                         std::string(dev.second.device_id_));
+
+    /* values */
+    for(const auto &staged_dev : staged.devices_)
+    {
+        auto &dev(devices_.at(staged_dev.first));
+        std::vector<std::pair<std::string, std::string>> gone;
+
+        for(const auto &elem : dev.get_elements())
+        {
+            const auto staged_elem(staged_dev.second.get_elements().find(elem.first));
+
+            for(const auto &val : elem.second.get_values())
+                if(staged_elem == staged_dev.second.get_elements().end() ||
+                   staged_elem->second.get_values().find(val.first) ==
+                   staged_elem->second.get_values().end())
+                    gone.emplace_back(elem.first, val.first);
+        }
+
+        for(const auto &g : gone)
+        {
+            ConfigStore::Value old_value;
+            dev.unset_value(g.first, g.second, old_value);
+            log_->set_value(dev.name_ + '.' + g.first + '.' + g.second,
+                            std::move(old_value), ConfigStore::Value());
+        }
+
+        for(const auto &staged_elem : staged_dev.second.get_elements())
+        {
+            for(const auto &staged_val : staged_elem.second.get_values())
+            {
+                const auto elem(dev.get_elements().find(staged_elem.first));
+
+                if(elem != dev.get_elements().end())
+                {
+                    const auto val(elem->second.get_values().find(staged_val.first));
+                    if(val != elem->second.get_values().end() &&
+                       val->second == staged_val.second)
+                        continue;
+                }
+
+                ConfigStore::Value old_value;
+                const auto &new_value(
+                    dev.set_value(staged_elem.first, staged_val.first,
+                                  ConfigStore::Value(staged_val.second),
+                                  old_value));
+                log_->set_value(dev.name_ + '.' + staged_elem.first + '.' + staged_val.first,
+                                std::move(old_value), ConfigStore::Value(new_value));
+            }
+        }
+    }
+
+    /* connections */
+    for(auto &dev : devices_)
+    {
+        const auto &staged_conns(staged.devices_.at(dev.first).get_outgoing_connections());
+        std::vector<std::tuple<std::string, std::string, std::string>> gone;
+
+        for(const auto &conn : dev.second.get_outgoing_connections())
+        {
+            const auto staged_conn(staged_conns.find(conn.first));
+
+            for(const auto &target : conn.second)
+                if(staged_conn == staged_conns.end() ||
+                   staged_conn->second.find(target) == staged_conn->second.end())
+                    gone.emplace_back(conn.first.first, conn.first.second, target);
+        }
+
+        for(const auto &g : gone)
+            dev.second.remove_connection_on_sink(std::get<0>(g), std::get<1>(g),
+                                                 std::get<2>(g), *log_);
+
+        for(const auto &staged_conn : staged_conns)
+        {
+            const auto conn(dev.second.get_outgoing_connections().find(staged_conn.first));
+
+            for(const auto &target : staged_conn.second)
+            {
+                if(conn != dev.second.get_outgoing_connections().end() &&
+                   conn->second.find(target) != conn->second.end())
+                    continue;
+
+                dev.second.add_connection(staged_conn.first.first,
+                                          staged_conn.first.second, target);
+                log_->add_connection(dev.first + '.' + staged_conn.first.first,
+                                     staged_conn.first.second + '.' + target);
+            }
+        }
+    }
+}
+
 static std::tuple<Device &, std::string>
 get_device_and_element_name(const std::string &qualified_name,
                             std::unordered_map<std::string, Device> &devices)
@@ -1079,39 +1647,6 @@ void ConfigStore::Settings::Impl::remove_all_connections()
         dev.second.remove_connections(*log_);
 }
 
-const StaticModels::DeviceModel *
-ConfigStore::Settings::Impl::get_device_model(const std::string &name)
-{
-    const auto dm(models_.find(name));
-    if(dm != models_.end())
-        return dm->second.get();
-
-    models_.emplace(name, nullptr);
-
-    const auto &model(models_database_.get_device_model_definition(name));
-    if(model.is_null())
-    {
-        msg_error(0, LOG_NOTICE,
-                  "No model defined for device ID \"%s\"", name.c_str());
-        return nullptr;
-    }
-
-    try
-    {
-        models_.erase(name);
-        return
-            models_.emplace(name,
-                std::make_unique<StaticModels::DeviceModel>(
-                    StaticModels::DeviceModel::mk_model(std::string(name), model)))
-            .first->second.get();
-    }
-    catch(const std::exception &e)
-    {
-        msg_error(0, LOG_NOTICE, "%s", e.what());
-        return nullptr;
-    }
-}
-
 nlohmann::json ConfigStore::Settings::Impl::json() const
 {
     nlohmann::json result({});
@@ -1127,12 +1662,23 @@ nlohmann::json ConfigStore::Settings::Impl::json() const
                 continue;
 
             auto &e(result["settings"][dev.second.name_][elem.second.name_] = nullptr);
+            const auto *model = dev.second.get_model();
 
             for(const auto &param : elem.second.get_values())
             {
                 auto &val(e[param.first]);
                 val["value"] = param.second.get_value();
                 val["type"] = std::string(1, param.second.get_type_code());
+
+                const auto *ctrl(model != nullptr
+                                 ? model->get_control_by_name(elem.second.name_,
+                                                              param.first)
+                                 : nullptr);
+                if(ctrl != nullptr)
+                    ctrl->for_each_scaled_value(
+                        param.second,
+                        [&val] (const std::string &scale, double v)
+                        { val["scales"][scale] = v; });
             }
         }
     }
@@ -1152,8 +1698,8 @@ nlohmann::json ConfigStore::Settings::Impl::json() const
     return result;
 }
 
-ConfigStore::Settings::Settings(const StaticModels::DeviceModelsDatabase &models_database):
-    impl_(std::make_unique<Impl>(models_database))
+ConfigStore::Settings::Settings(StaticModels::DeviceModelCache &models):
+    impl_(std::make_unique<Impl>(models))
 {}
 
 ConfigStore::Settings::~Settings() = default;
@@ -1163,11 +1709,46 @@ void ConfigStore::Settings::clear()
     impl_ = Impl::make_fresh(std::move(impl_));
 }
 
-void ConfigStore::Settings::update(const std::string &d)
+/*!
+ * Mark all data as outdated.
+ *
+ * The data are kept so that a following full state declaration can be
+ * applied as a set of differences. In case the next update is not a full
+ * state declaration, all data are discarded before the update is applied.
+ */
+void ConfigStore::Settings::invalidate()
+{
+    impl_->invalidate();
+}
+
+/*!
+ * Whether or not the data have been marked as outdated.
+ */
+bool ConfigStore::Settings::is_stale() const
+{
+    return impl_->is_stale();
+}
+
+/*!
+ * Switch all instances over to the models currently in the model cache.
+ *
+ * This function must be called after models have been replaced in the
+ * #StaticModels::DeviceModelCache, and before the replaced models are
+ * destroyed. Pending changes should have been extracted before.
+ *
+ * \returns
+ *     True if any instance is using a different model now.
+ */
+bool ConfigStore::Settings::reattach_models()
+{
+    return impl_->reattach_models();
+}
+
+void ConfigStore::Settings::update(const std::string &d, UpdateMode mode)
 {
     try
     {
-        impl_->update(nlohmann::json::parse(d));
+        impl_->update(nlohmann::json::parse(d), mode);
     }
     catch(const std::exception &e)
     {
@@ -1201,11 +1782,12 @@ nlohmann::json ConfigStore::ConstSettingsJSON::json() const
     }
 }
 
-void ConfigStore::SettingsJSON::update(const nlohmann::json &j)
+void ConfigStore::SettingsJSON::update(const nlohmann::json &j,
+                                       Settings::UpdateMode mode)
 {
     try
     {
-        settings_.impl_->update(j);
+        settings_.impl_->update(j, mode);
     }
     catch(const std::exception &e)
     {
@@ -1230,6 +1812,17 @@ ConfigStore::SettingsIterator::with_device(const std::string &device_name) const
     return DeviceContext(settings_.impl_->get_device(device_name));
 }
 
+/*!
+ * Enumerate all audio connections between device instances.
+ *
+ * Each connection is reported as pair of sink of the source device and input
+ * of the target device.
+ */
+void ConfigStore::SettingsIterator::for_each_connection(const ConnectionFn &apply) const
+{
+    settings_.impl_->for_each_connection(apply);
+}
+
 void ConfigStore::DeviceContext::for_each_setting(const SettingReportFn &apply) const
 {
     for(const auto &elem : device_.get_elements())
@@ -1266,6 +1859,55 @@ bool ConfigStore::DeviceContext::for_each_signal_path(
         : false;
 }
 
+/*!
+ * Enumerate active signal paths ending in the given sink.
+ *
+ * Nothing is enumerated if there is no such sink, or if the device has no
+ * signal paths.
+ */
+bool ConfigStore::DeviceContext::for_each_signal_path_to_sink(
+        const std::string &sink_name,
+        const ModelCompliant::SignalPathTracker::EnumerateCallbackFn &apply) const
+{
+    const auto *sp = device_.get_signal_paths();
+    if(sp == nullptr)
+        return true;
+
+    const auto *sink = sp->get_appliance().lookup_element(sink_name);
+    return sink != nullptr
+        ? sp->enumerate_active_signal_paths_to_sink(*sink, apply)
+        : true;
+}
+
+/*!
+ * Names of the signal types transported along an active path.
+ */
+std::vector<std::string>
+ConfigStore::DeviceContext::get_signal_types(
+        const ModelCompliant::SignalPathTracker::ActivePath &path) const
+{
+    const auto *sp = device_.get_signal_paths();
+    return sp != nullptr
+        ? sp->get_appliance().to_names(sp->get_signal_types(path))
+        : std::vector<std::string>();
+}
+
+/*!
+ * Names of the signal types currently arriving at the given sink.
+ */
+std::vector<std::string>
+ConfigStore::DeviceContext::get_signal_types(const std::string &sink_name) const
+{
+    const auto *sp = device_.get_signal_paths();
+    if(sp == nullptr)
+        return std::vector<std::string>();
+
+    const auto *sink = sp->get_appliance().lookup_element(sink_name);
+    return sink != nullptr && sink->is_sink()
+        ? sp->get_appliance().to_names(sp->get_signal_types(*sink))
+        : std::vector<std::string>();
+}
+
 const ConfigStore::Value *
 ConfigStore::DeviceContext::get_control_value(const std::string &element_id,
                                               const std::string &control_id) const
@@ -1281,6 +1923,31 @@ ConfigStore::DeviceContext::get_control_value(const std::string &element_id,
     return &val->second;
 }
 
+/*!
+ * Get value of control converted to given scale.
+ *
+ * The conversion uses the tables defined in the model, see
+ * #StaticModels::Elements::Control::to_scale().
+ *
+ * \returns
+ *     True on success, false if the value is unknown or cannot be converted.
+ */
+bool ConfigStore::DeviceContext::get_control_value_in_scale(
+        const std::string &element_id, const std::string &control_id,
+        const std::string &scale, double &result) const
+{
+    const auto *model = device_.get_model();
+    if(model == nullptr)
+        return false;
+
+    const auto *ctrl = model->get_control_by_name(element_id, control_id);
+    if(ctrl == nullptr)
+        return false;
+
+    const auto *value = get_control_value(element_id, control_id);
+    return value != nullptr && ctrl->to_scale(*value, scale, result);
+}
+
 const std::map<std::pair<std::string, std::string>,
                std::unordered_set<std::string>> &
 ConfigStore::DeviceContext::get_outgoing_connections() const
@@ -25,7 +25,7 @@
 #include <string>
 #include <memory>
 
-namespace StaticModels { class DeviceModelsDatabase; }
+namespace StaticModels { class DeviceModelCache; }
 
 namespace ConfigStore
 {
@@ -37,9 +37,11 @@ class SettingsIterator;
  * All settings as reported by the appliance.
  *
  * The settings stored in this object are not matched against the device
- * models (though the models are built when referenced and owned by this
- * object). Instead, they represent raw, live data as reported by the appliance
- * as AuPaL objects.
+ * models (though the models are built when referenced). Instead, they
+ * represent raw, live data as reported by the appliance as AuPaL objects.
+ *
+ * The models are owned by a #StaticModels::DeviceModelCache which outlives
+ * this object, so that they are kept when the settings are cleared.
  *
  * \see
  *     #ConfigStore::ConstSettingsJSON, #ConfigStore::SettingsJSON
@@ -55,16 +57,43 @@ class Settings
     friend class SettingsIterator;
 
   public:
+    /*!
+     * How #ConfigStore::Settings::update() treats its input.
+     */
+    enum class UpdateMode
+    {
+        /*! Apply changes one by one, just as they come in. */
+        INCREMENTAL,
+
+        /*!
+         * The input declares the complete state. It is applied to a staging
+         * area first, and only the differences between the staged and the
+         * current state are applied to the store.
+         */
+        REPLACE_ALL,
+
+        /*!
+         * Use #ConfigStore::Settings::UpdateMode::REPLACE_ALL for input which
+         * starts with clearing all instances (which is how full state
+         * declarations look like), otherwise use
+         * #ConfigStore::Settings::UpdateMode::INCREMENTAL.
+         */
+        DETECT_FULL_STATE,
+    };
+
     Settings(const Settings &) = delete;
     Settings(Settings &&) = default;
     Settings &operator=(const Settings &) = delete;
     Settings &operator=(Settings &&) = default;
 
-    explicit Settings(const StaticModels::DeviceModelsDatabase &models_database);
+    explicit Settings(StaticModels::DeviceModelCache &models);
     ~Settings();
 
     void clear();
-    void update(const std::string &d);
+    void invalidate();
+    bool is_stale() const;
+    void update(const std::string &d, UpdateMode mode = UpdateMode::INCREMENTAL);
+    bool reattach_models();
     std::string json_string() const;
 };
 
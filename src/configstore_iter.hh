@@ -67,8 +67,18 @@ class DeviceContext
                           const SettingReportFn &apply) const;
     bool for_each_signal_path(
             const ModelCompliant::SignalPathTracker::EnumerateCallbackFn &apply) const;
+    bool for_each_signal_path_to_sink(
+            const std::string &sink_name,
+            const ModelCompliant::SignalPathTracker::EnumerateCallbackFn &apply) const;
+    std::vector<std::string>
+    get_signal_types(const ModelCompliant::SignalPathTracker::ActivePath &path) const;
+    std::vector<std::string> get_signal_types(const std::string &sink_name) const;
     const Value *get_control_value(const std::string &element_id,
                                    const std::string &control_id) const;
+    bool get_control_value_in_scale(const std::string &element_id,
+                                    const std::string &control_id,
+                                    const std::string &scale,
+                                    double &result) const;
     const std::map<std::pair<std::string, std::string>,
                    std::unordered_set<std::string>> &
     get_outgoing_connections() const;
@@ -99,6 +109,13 @@ class SettingsIterator
 
     DeviceContext with_device(const char *device_name) const;
     DeviceContext with_device(const std::string &device_name) const;
+
+    using ConnectionFn =
+        std::function<void(const std::string &source_device,
+                           const std::string &sink_name,
+                           const std::string &target_device,
+                           const std::string &input_name)>;
+    void for_each_connection(const ConnectionFn &apply) const;
 };
 
 }
@@ -31,11 +31,12 @@
 #include "json.hh"
 #pragma GCC diagnostic pop
 
+#include "configstore.hh"
+
 namespace ConfigStore
 {
 
 class Changes;
-class Settings;
 
 /*!
  * Read-only wrapper around #ConfigStore::Settings for direct use of JSON.
@@ -88,7 +89,8 @@ class SettingsJSON
 
     const ConstSettingsJSON &const_iface() const { return const_settings_; }
 
-    void update(const nlohmann::json &j);
+    void update(const nlohmann::json &j,
+                Settings::UpdateMode mode = Settings::UpdateMode::INCREMENTAL);
     bool extract_changes(Changes &changes);
 };
 
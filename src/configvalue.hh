@@ -35,6 +35,11 @@
 #pragma GCC diagnostic pop
 
 #include <string>
+#include <string_view>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
 
 namespace ConfigStore
 {
@@ -64,13 +69,48 @@ bool type_check(const nlohmann::json &value, ValueType vt,
 template <ValueType VT> struct ValueTypeTraits;
 
 /*!
- * Simple variant type based on nlohmann::json (for simplicity).
+ * Compact variant type for values of any #ConfigStore::ValueType.
+ *
+ * Numbers and Booleans are stored inline, and so are strings of up to 16
+ * bytes length. Longer strings are stored on the heap. T+A fixed-point values
+ * are stored in their native integer representation so that they can be
+ * compared exactly.
+ *
+ * Strings which have been resolved against the list of choices of a
+ * #StaticModels::Elements::Choice control are stored as index into that list.
+ * The list is owned by the device model, which must outlive the value.
+ *
+ * Conversion from and to JSON is done only at the boundaries, e.g., when
+ * parsing audio path changes or when generating reports.
  */
 class Value
 {
   private:
+    static constexpr uint8_t HEAP_STRING = std::numeric_limits<uint8_t>::max();
+    static constexpr uint8_t CHOICE_INDEX = HEAP_STRING - 1;
+
     ValueType type_;
-    nlohmann::json value_;
+
+    /* length of inline string, #HEAP_STRING, or #CHOICE_INDEX */
+    uint8_t inline_length_;
+
+    union Data
+    {
+        bool bool_;
+        int64_t signed_;
+        uint64_t unsigned_;
+        double double_;
+        char inline_string_[16];
+        std::string *heap_string_;
+
+        struct
+        {
+            const std::vector<std::string> *choices_;
+            uint32_t index_;
+        }
+        choice_;
+    }
+    data_;
 
     static const std::array<const std::pair<const char, const ValueType>, 13>
     TYPE_CODE_TO_VALUE_TYPE;
@@ -83,27 +123,95 @@ class Value
                   "unexpected array size");
 
   public:
-    Value(const Value &) = default;
-    Value(Value &&) = default;
-    Value &operator=(const Value &) = delete;
-    Value &operator=(Value &&) = default;
+    static constexpr size_t INLINE_STRING_CAPACITY = sizeof(Data::inline_string_);
+
+    /*! T+A fixed-point values are stored as multiples of 1/16 */
+    static constexpr int64_t FIX_POINT_SCALE = 16;
+
+    Value(const Value &src):
+        type_(src.type_),
+        inline_length_(src.inline_length_),
+        data_(src.data_)
+    {
+        if(inline_length_ == HEAP_STRING)
+            data_.heap_string_ = new std::string(*src.data_.heap_string_);
+    }
+
+    Value(Value &&src) noexcept:
+        type_(src.type_),
+        inline_length_(src.inline_length_),
+        data_(src.data_)
+    {
+        src.type_ = ValueType::VT_VOID;
+        src.inline_length_ = 0;
+    }
 
-    explicit Value(): type_(ValueType::VT_VOID) {}
+    Value &operator=(const Value &) = delete;
 
-    explicit Value(const std::string &type_code, nlohmann::json &&value):
-        type_(type_code_to_type(type_code)),
-        value_(std::move(value))
+    Value &operator=(Value &&src) noexcept
     {
-        validate();
+        if(this != &src)
+        {
+            release();
+            type_ = src.type_;
+            inline_length_ = src.inline_length_;
+            data_ = src.data_;
+            src.type_ = ValueType::VT_VOID;
+            src.inline_length_ = 0;
+        }
+
+        return *this;
     }
 
-    explicit Value(const ValueType &vtype, nlohmann::json &&value):
+    explicit Value():
+        type_(ValueType::VT_VOID),
+        inline_length_(0),
+        data_{}
+    {}
+
+    explicit Value(const std::string &type_code, const nlohmann::json &value):
+        Value(type_code_to_type(type_code), value)
+    {}
+
+    explicit Value(const ValueType &vtype, const nlohmann::json &value):
         type_(vtype),
-        value_(std::move(value))
+        inline_length_(0),
+        data_{}
+    {
+        set_from_json(value);
+    }
+
+    ~Value() { release(); }
+
+    static Value mk_bool(bool value)
+    {
+        Value v(ValueType::VT_BOOL);
+        v.data_.bool_ = value;
+        return v;
+    }
+
+    static Value mk_string(const std::string &value)
+    {
+        Value v(ValueType::VT_ASCIIZ);
+        v.set_string(value);
+        return v;
+    }
+
+    static Value mk_choice(const std::vector<std::string> &choices,
+                           unsigned int index)
     {
-        validate();
+        Value v(ValueType::VT_ASCIIZ);
+        v.data_.choice_.choices_ = &choices;
+        v.data_.choice_.index_ = index;
+        v.inline_length_ = CHOICE_INDEX;
+        return v;
     }
 
+    static Value mk_signed(ValueType vtype, int64_t value);
+    static Value mk_unsigned(ValueType vtype, uint64_t value);
+    static Value mk_double(ValueType vtype, double value);
+    static Value mk_fix_point(int64_t native);
+
     bool is_of_type(ValueType vt) const { return type_ == vt; }
     bool equals_type_of(const Value &other) const { return type_ == other.type_; }
 
@@ -157,43 +265,94 @@ class Value
         return false;
     }
 
-    const auto &get_value() const { return value_; }
-    ValueType get_type() const { return type_; }
-    char get_type_code() const { return type_to_type_code(type_); }
-
-    nlohmann::json get_as(ValueType vt) const
+    bool is_unsigned() const
     {
-        switch(vt)
+        switch(type_)
         {
-          case ConfigStore::ValueType::VT_VOID:
+          case ValueType::VT_UINT8:
+          case ValueType::VT_UINT16:
+          case ValueType::VT_UINT32:
+          case ValueType::VT_UINT64:
+            return true;
+
+          default:
             break;
+        }
 
-          case ConfigStore::ValueType::VT_ASCIIZ:
-            return value_.get<std::string>();
+        return false;
+    }
 
-          case ConfigStore::ValueType::VT_BOOL:
-            return value_.get<bool>();
+    bool get_bool() const
+    {
+        if(type_ != ValueType::VT_BOOL)
+            type_error("bool");
 
-          case ConfigStore::ValueType::VT_INT8:
-          case ConfigStore::ValueType::VT_INT16:
-          case ConfigStore::ValueType::VT_INT32:
-          case ConfigStore::ValueType::VT_INT64:
-            return value_.get<int64_t>();
+        return data_.bool_;
+    }
 
-          case ConfigStore::ValueType::VT_UINT8:
-          case ConfigStore::ValueType::VT_UINT16:
-          case ConfigStore::ValueType::VT_UINT32:
-          case ConfigStore::ValueType::VT_UINT64:
-            return value_.get<uint64_t>();
+    std::string_view get_string() const
+    {
+        if(type_ != ValueType::VT_ASCIIZ)
+            type_error("string");
 
-          case ConfigStore::ValueType::VT_DOUBLE:
-          case ConfigStore::ValueType::VT_TA_FIX_POINT:
-            return value_.get<double>();
+        switch(inline_length_)
+        {
+          case HEAP_STRING:
+            return *data_.heap_string_;
+
+          case CHOICE_INDEX:
+            return (*data_.choice_.choices_)[data_.choice_.index_];
+
+          default:
+            return std::string_view(data_.inline_string_, inline_length_);
         }
+    }
+
+    bool is_choice_of(const std::vector<std::string> &choices) const
+    {
+        return inline_length_ == CHOICE_INDEX &&
+               data_.choice_.choices_ == &choices;
+    }
+
+    unsigned int get_choice_index() const
+    {
+        if(inline_length_ != CHOICE_INDEX)
+            type_error("choice");
+
+        return data_.choice_.index_;
+    }
+
+    int64_t get_int64() const { return get_number<int64_t>(); }
+    uint64_t get_uint64() const { return get_number<uint64_t>(); }
+    double get_double() const { return get_number<double>(); }
+
+    /*!
+     * Get numeric value as T+A fixed-point number in native representation.
+     *
+     * Values of other numeric types are converted, and an exception is
+     * thrown if they are out of range.
+     */
+    int64_t get_fix_point_native() const
+    {
+        if(type_ == ValueType::VT_TA_FIX_POINT)
+            return data_.signed_;
 
-        return nullptr;
+        return fix_point_from_double(get_double());
     }
 
+    static int64_t fix_point_from_double(double value);
+
+    static constexpr double fix_point_to_double(int64_t native)
+    {
+        return double(native) / FIX_POINT_SCALE;
+    }
+
+    nlohmann::json get_value() const;
+    ValueType get_type() const { return type_; }
+    char get_type_code() const { return type_to_type_code(type_); }
+
+    nlohmann::json get_as(ValueType vt) const;
+
     static char type_to_type_code(ValueType vt)
     {
         return VALUE_TYPE_TO_TYPE_CODE[size_t(vt)];
@@ -203,16 +362,87 @@ class Value
 
     bool operator==(const Value &other) const
     {
-        return type_ == other.type_ && value_ == other.value_;
+        if(type_ != other.type_)
+            return false;
+
+        if(inline_length_ == CHOICE_INDEX &&
+           other.is_choice_of(*data_.choice_.choices_))
+            return data_.choice_.index_ == other.data_.choice_.index_;
+
+        return compare(other) == 0;
     }
 
+    bool operator!=(const Value &other) const { return !(*this == other); }
+
     bool operator<(const Value &other) const
     {
-        return type_ == other.type_ && value_ < other.value_;
+        return type_ == other.type_ && compare(other) < 0;
     }
 
   private:
-    void validate() const { type_check(value_, type_, true); }
+    explicit Value(ValueType vtype):
+        type_(vtype),
+        inline_length_(0),
+        data_{}
+    {}
+
+    void release()
+    {
+        if(inline_length_ == HEAP_STRING)
+            delete data_.heap_string_;
+
+        inline_length_ = 0;
+    }
+
+    void set_string(const std::string &value)
+    {
+        if(value.size() <= INLINE_STRING_CAPACITY)
+        {
+            std::copy(value.begin(), value.end(), data_.inline_string_);
+            inline_length_ = uint8_t(value.size());
+        }
+        else
+        {
+            data_.heap_string_ = new std::string(value);
+            inline_length_ = HEAP_STRING;
+        }
+    }
+
+    template <typename T>
+    T get_number() const
+    {
+        switch(type_)
+        {
+          case ValueType::VT_VOID:
+          case ValueType::VT_ASCIIZ:
+          case ValueType::VT_BOOL:
+            break;
+
+          case ValueType::VT_INT8:
+          case ValueType::VT_INT16:
+          case ValueType::VT_INT32:
+          case ValueType::VT_INT64:
+            return T(data_.signed_);
+
+          case ValueType::VT_UINT8:
+          case ValueType::VT_UINT16:
+          case ValueType::VT_UINT32:
+          case ValueType::VT_UINT64:
+            return T(data_.unsigned_);
+
+          case ValueType::VT_DOUBLE:
+            return T(data_.double_);
+
+          case ValueType::VT_TA_FIX_POINT:
+            return T(fix_point_to_double(data_.signed_));
+        }
+
+        type_error("number");
+    }
+
+    void set_from_json(const nlohmann::json &value);
+    int compare(const Value &other) const;
+    [[ noreturn ]] void type_error(const char *expected) const;
 };
 
 template <>
@@ -251,21 +481,52 @@ template <>
 struct ValueTypeTraits<ValueType::VT_DOUBLE>
 { using TargetType = double; using GetType = double; };
 
+template <ValueType VT, typename Traits = ValueTypeTraits<VT>>
+bool is_in_range(const typename Traits::GetType &v)
+{
+    return v <= std::numeric_limits<typename Traits::TargetType>::max() &&
+           v >= std::numeric_limits<typename Traits::TargetType>::lowest();
+}
+
+template <ValueType VT, typename Traits = ValueTypeTraits<VT>>
+[[ noreturn ]] void out_of_range_error(const nlohmann::json &value)
+{
+    Error() <<
+        "value " << value << " out of range [" <<
+        typename Traits::GetType(std::numeric_limits<typename Traits::TargetType>::lowest()) <<
+        ", " <<
+        typename Traits::GetType(std::numeric_limits<typename Traits::TargetType>::max()) <<
+        "] according to type code " << Value::type_to_type_code(VT);
+}
+
 template <ValueType VT, typename Traits = ValueTypeTraits<VT>>
 typename Traits::TargetType get_range_checked(const nlohmann::json &value)
 {
     const auto v(value.get<typename Traits::GetType>());
 
-    if(v > std::numeric_limits<typename Traits::TargetType>::max() ||
-       v < std::numeric_limits<typename Traits::TargetType>::lowest())
-    {
-        Error() <<
-            "value " << value << " out of range [" <<
-            typename Traits::GetType(std::numeric_limits<typename Traits::TargetType>::lowest()) <<
-            ", " <<
-            typename Traits::GetType(std::numeric_limits<typename Traits::TargetType>::max()) <<
-            "] according to type code " << Value::type_to_type_code(VT);
-    }
+    if(!is_in_range<VT>(v))
+        out_of_range_error<VT>(value);
+
+    return v;
+}
+
+/*!
+ * Like #ConfigStore::get_range_checked(), but without going through JSON.
+ */
+template <ValueType VT, typename Traits = ValueTypeTraits<VT>>
+typename Traits::TargetType get_range_checked(const Value &value)
+{
+    typename Traits::GetType v;
+
+    if constexpr(std::is_same_v<typename Traits::GetType, int64_t>)
+        v = value.get_int64();
+    else if constexpr(std::is_same_v<typename Traits::GetType, uint64_t>)
+        v = value.get_uint64();
+    else
+        v = value.get_double();
+
+    if(!is_in_range<VT>(v))
+        out_of_range_error<VT>(value.get_value());
 
     return v;
 }
@@ -29,6 +29,13 @@
 #include "messages.h"
 
 #include <fstream>
+#include <unordered_set>
+#include <set>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <system_error>
 
 static bool do_load(std::ifstream &in, bool suppress_error,
                     nlohmann::json &config_data,
@@ -59,6 +66,8 @@ bool StaticModels::DeviceModelsDatabase::load(const std::string &config,
                                               bool suppress_error)
 {
     std::ifstream in(config);
+    compiled_ = nullptr;
+    released_.clear();
     return do_load(in, suppress_error, config_data_,
                    [&config] (const char *msg)
                    { msg_error(0, LOG_ERR, msg, config.c_str()); });
@@ -68,6 +77,8 @@ bool StaticModels::DeviceModelsDatabase::load(const char *config,
                                               bool suppress_error)
 {
     std::ifstream in(config);
+    compiled_ = nullptr;
+    released_.clear();
     return do_load(in, suppress_error, config_data_,
                    [&config] (const char *msg)
                    { msg_error(0, LOG_ERR, msg, config); });
@@ -76,6 +87,9 @@ bool StaticModels::DeviceModelsDatabase::load(const char *config,
 bool StaticModels::DeviceModelsDatabase::loads(const std::string &js,
                                                bool suppress_error)
 {
+    compiled_ = nullptr;
+    released_.clear();
+
     try
     {
         config_data_ = nlohmann::json::parse(js);
@@ -141,24 +155,194 @@ static void flatten_device(const std::string &device_name, std::set<std::string>
     device.erase("copy_properties");
 }
 
+/*!
+ * Replace "$parameter" placeholders in template by arguments.
+ *
+ * Only strings which consist of a declared parameter name are replaced. The
+ * names of all substituted parameters are added to \p used.
+ */
+static void substitute_parameters(nlohmann::json &j,
+                                  const std::set<std::string> &parameters,
+                                  const nlohmann::json &args,
+                                  const std::string &instance_name,
+                                  std::set<std::string> &used)
+{
+    if(j.is_structured())
+    {
+        for(auto &v : j)
+            substitute_parameters(v, parameters, args, instance_name, used);
+
+        return;
+    }
+
+    if(!j.is_string())
+        return;
+
+    const auto &str(j.get_ref<const std::string &>());
+    if(str.size() < 2 || str[0] != '$' || parameters.find(str) == parameters.end())
+        return;
+
+    std::string name(str.substr(1));
+    const auto arg(args.find(name));
+
+    if(arg == args.end())
+        Error() << "Parameter \"" << name << "\" missing for predefined element "
+                << instance_name;
+
+    j = *arg;
+    used.insert(std::move(name));
+}
+
+/*!
+ * Instantiate predefined element template.
+ *
+ * The template is looked up in the "predefined_elements" object of the device
+ * named in the reference, which has the form "Device.template". The result is
+ * the template with its placeholders replaced by the arguments found in
+ * \p instance. All other fields of \p instance which are not used as
+ * arguments (such as "description") are copied over unless the template
+ * defines them already.
+ */
+static nlohmann::json
+instantiate_predefined_element(const nlohmann::json &instance,
+                               const nlohmann::json &all_devices,
+                               const std::string &instance_name)
+{
+    const auto &ref(instance.at("predefined").get_ref<const std::string &>());
+    const auto dot(ref.find('.'));
+
+    if(dot == std::string::npos)
+        Error() << "Invalid reference to predefined element \"" << ref
+                << "\" in " << instance_name;
+
+    const auto dev(all_devices.find(ref.substr(0, dot)));
+    if(dev == all_devices.end())
+        Error() << "Device of predefined element \"" << ref
+                << "\" not found for " << instance_name;
+
+    const auto defs(dev->find("predefined_elements"));
+    if(defs == dev->end())
+        Error() << "Device of predefined element \"" << ref
+                << "\" defines no predefined elements for " << instance_name;
+
+    const auto tmpl(defs->find(ref.substr(dot + 1)));
+    if(tmpl == defs->end())
+        Error() << "Predefined element \"" << ref << "\" not found for "
+                << instance_name;
+
+    std::set<std::string> parameters;
+    const auto params(tmpl->find("parameters"));
+    if(params != tmpl->end())
+        for(const auto &p : *params)
+            parameters.insert(p.get<std::string>());
+
+    nlohmann::json result(*tmpl);
+    result.erase("parameters");
+
+    std::set<std::string> used;
+    substitute_parameters(result, parameters, instance, instance_name, used);
+
+    for(const auto &kv : instance.items())
+        if(kv.key() != "predefined" && used.find(kv.key()) == used.end() &&
+           result.find(kv.key()) == result.end())
+            result[kv.key()] = kv.value();
+
+    return result;
+}
+
+/*!
+ * Expand all references to predefined elements in given device.
+ *
+ * Expansions are memoized in \p expanded so that identical instantiations
+ * (same template, same arguments) are computed only once per database.
+ */
+static void expand_predefined_elements(const std::string &device_name,
+                                       nlohmann::json &device,
+                                       const nlohmann::json &all_devices,
+                                       std::unordered_map<std::string, nlohmann::json> &expanded)
+{
+    const auto elements(device.find("elements"));
+    if(elements == device.end())
+        return;
+
+    for(auto &elem : *elements)
+    {
+        const auto e(elem.find("element"));
+        if(e == elem.end() || e->find("predefined") == e->end())
+            continue;
+
+        auto key(e->dump());
+        const auto found(expanded.find(key));
+
+        if(found != expanded.end())
+            *e = found->second;
+        else
+        {
+            *e = instantiate_predefined_element(
+                    *e, all_devices,
+                    device_name + '.' + elem.at("id").get<std::string>());
+            expanded.emplace(std::move(key), *e);
+        }
+    }
+}
+
+/*!
+ * Resolve copied properties and predefined elements.
+ *
+ * After this function has returned, each model definition is self-contained.
+ */
 void StaticModels::DeviceModelsDatabase::flatten()
 {
     if(config_data_.find("all_devices") == config_data_.end())
         return;
 
-    for(auto &device : config_data_["all_devices"].items())
+    auto &all_devices(config_data_["all_devices"]);
+
+    for(auto &device : all_devices.items())
     {
         if(device.value().find("copy_properties") == device.value().end())
             continue;
 
         std::set<std::string> seen { device.key() };
-        flatten_device(device.key(), seen, device.value(), config_data_["all_devices"]);
+        flatten_device(device.key(), seen, device.value(), all_devices);
     }
+
+    std::unordered_map<std::string, nlohmann::json> expanded;
+
+    for(auto &device : all_devices.items())
+        expand_predefined_elements(device.key(), device.value(), all_devices,
+                                   expanded);
+}
+
+void StaticModels::DeviceModelsDatabase::for_each_device_id(
+        const std::function<void(const std::string &)> &apply) const
+{
+    if(compiled_ != nullptr)
+    {
+        for_each_compiled_device_id(apply);
+        return;
+    }
+
+    const auto all_devices(config_data_.find("all_devices"));
+    if(all_devices == config_data_.end())
+        return;
+
+    std::vector<std::string> ids;
+    for(const auto &device : all_devices->items())
+        ids.push_back(device.key());
+
+    std::sort(ids.begin(), ids.end());
+
+    for(const auto &id : ids)
+        apply(id);
 }
 
 const nlohmann::json &
 StaticModels::DeviceModelsDatabase::get_device_model_definition(const std::string &device_id) const
 {
+    if(compiled_ != nullptr)
+        return get_compiled_definition(device_id);
+
     try
     {
         return config_data_.at("all_devices").at(device_id);
@@ -170,10 +354,137 @@ StaticModels::DeviceModelsDatabase::get_device_model_definition(const std::strin
     }
 }
 
+size_t
+StaticModels::DeviceModelsDatabase::get_definition_hash(const std::string &device_id) const
+{
+    const auto it(released_.find(device_id));
+    return it != released_.end()
+        ? it->second
+        : std::hash<nlohmann::json>{}(get_device_model_definition(device_id));
+}
+
+/*!
+ * Drop JSON definition of given device model.
+ *
+ * The hash over the definition is kept so that
+ * #StaticModels::DeviceModelCache::sync_with_database() continues to work.
+ * Compiled definitions are parsed again from the mapped file in case they are
+ * requested later, plain JSON definitions are gone until the next reload.
+ */
+void StaticModels::DeviceModelsDatabase::release_definition(const std::string &device_id)
+{
+    if(released_.find(device_id) != released_.end())
+        return;
+
+    const auto &definition(get_device_model_definition(device_id));
+    if(definition.is_null())
+        return;
+
+    released_.emplace(device_id, std::hash<nlohmann::json>{}(definition));
+
+    if(compiled_ != nullptr)
+        release_compiled_definition(device_id);
+    else
+        config_data_["all_devices"][device_id] = nullptr;
+}
+
+/*!
+ * Extract the "roon" section of a control definition, if any.
+ *
+ * Only the rank is interpreted here. The remaining conversion specification
+ * is copied out of the model definition so that the latter needs not be kept
+ * around.
+ */
+static StaticModels::Elements::RoonControl
+parse_roon_control(const nlohmann::json &ctrl)
+{
+    const auto it(ctrl.find("roon"));
+    if(it == ctrl.end())
+        return StaticModels::Elements::RoonControl();
+
+    const auto rank(StaticModels::Utils::get<unsigned int>(*it, "rank", 0));
+    nlohmann::json conversion(*it);
+    conversion.erase("rank");
+    return StaticModels::Elements::RoonControl(rank, std::move(conversion));
+}
+
+/*!
+ * Extract the "roon" section of an audio sink definition, if any.
+ */
+static StaticModels::Elements::RoonSink
+parse_roon_sink(const nlohmann::json &sink)
+{
+    const auto it(sink.find("roon"));
+    if(it == sink.end())
+        return StaticModels::Elements::RoonSink();
+
+    const auto rank(StaticModels::Utils::get<uint16_t>(
+            *it, "rank", uint16_t(StaticModels::Elements::RoonSink::INVALID_RANK)));
+    auto method(StaticModels::Utils::get<std::string>(*it, "method", ""));
+
+    if(method.empty())
+        MSG_BUG("Roon output method undefined for sink %s",
+                sink.at("id").get_ref<const std::string &>().c_str());
+
+    return StaticModels::Elements::RoonSink(rank, std::move(method));
+}
+
+/*!
+ * Parse the "mapped_to_scales" object of a range control.
+ *
+ * Each scale maps to an object containing a "table" array with one number per
+ * value in the range.
+ */
+static std::vector<StaticModels::Elements::ScaleTable>
+parse_scale_tables(const std::string &control_id, const nlohmann::json &ctrl)
+{
+    std::vector<StaticModels::Elements::ScaleTable> result;
+
+    const auto it(ctrl.find("mapped_to_scales"));
+    if(it == ctrl.end())
+        return result;
+
+    for(const auto &scale : it->items())
+    {
+        const auto table(scale.value().find("table"));
+        if(table == scale.value().end() || !table->is_array())
+            Error() << "Mapping to scale \"" << scale.key()
+                    << "\" of control \"" << control_id
+                    << "\" must define a table";
+
+        std::vector<double> values;
+        values.reserve(table->size());
+
+        for(const auto &v : *table)
+        {
+            if(!v.is_number())
+                Error() << "Table for scale \"" << scale.key()
+                        << "\" of control \"" << control_id
+                        << "\" must contain only numbers";
+
+            values.push_back(v.get<double>());
+        }
+
+        result.emplace_back(std::string(scale.key()), std::move(values));
+    }
+
+    return result;
+}
+
 using DefinedControls =
-    std::unordered_map<std::string, std::unique_ptr<StaticModels::Elements::Control>>;
+    std::unordered_map<std::string, std::shared_ptr<const StaticModels::Elements::Control>>;
 
-static DefinedControls parse_controls(const nlohmann::json &elem)
+/*!
+ * Controls built while parsing a model, keyed by control ID and definition.
+ *
+ * Elements instantiated from the same predefined element usually have many
+ * identical controls (and mapping tables), so these are built only once.
+ */
+using ControlsMemo =
+    std::unordered_map<std::string, std::shared_ptr<const StaticModels::Elements::Control>>;
+
+static DefinedControls parse_controls(const nlohmann::json &elem,
+                                      ControlsMemo &memo)
 {
     DefinedControls result;
 
@@ -183,8 +494,19 @@ static DefinedControls parse_controls(const nlohmann::json &elem)
 
     for(const auto &control : it->items())
     {
-        const auto &ctrltype(control.value().at("type").get<std::string>());
         const auto &val(control.value());
+        auto memo_key(control.key() + '\0' + val.dump());
+        const auto known(memo.find(memo_key));
+
+        if(known != memo.end())
+        {
+            result.emplace(control.key(), known->second);
+            continue;
+        }
+
+        const auto &ctrltype(val.at("type").get<std::string>());
+
+        auto roon(parse_roon_control(val));
 
         auto label(StaticModels::Utils::get<std::string>(val, "label", ""));
         auto desc(StaticModels::Utils::get<std::string>(val, "description", ""));
@@ -195,7 +517,7 @@ static DefinedControls parse_controls(const nlohmann::json &elem)
             result.emplace(
                 control.key(),
                 std::make_unique<StaticModels::Elements::Choice>(
-                    val, std::string(control.key()),
+                    std::move(roon), std::string(control.key()),
                     std::move(label), std::move(desc),
                     std::vector<std::string>(ch.begin(), ch.end()),
                     StaticModels::Utils::get<std::string>(val, "neutral_setting", "")));
@@ -204,29 +526,32 @@ static DefinedControls parse_controls(const nlohmann::json &elem)
         {
             const auto &vtype(val.at("value_type").get<std::string>());
             auto neutral_setting(val.contains("neutral_setting")
-                    ? ConfigStore::Value(vtype, nlohmann::json(val["neutral_setting"]))
+                    ? ConfigStore::Value(vtype, val["neutral_setting"])
                     : ConfigStore::Value());
 
             result.emplace(
                 control.key(),
                 std::make_unique<StaticModels::Elements::Range>(
-                    val, std::string(control.key()),
+                    std::move(roon), std::string(control.key()),
                     std::move(label), std::move(desc),
                     val.at("scale").get<std::string>(),
-                    ConfigStore::Value(vtype, nlohmann::json(val.at("min"))),
-                    ConfigStore::Value(vtype, nlohmann::json(val.at("max"))),
-                    ConfigStore::Value(vtype, nlohmann::json(val.at("step"))),
-                    std::move(neutral_setting)));
+                    ConfigStore::Value(vtype, val.at("min")),
+                    ConfigStore::Value(vtype, val.at("max")),
+                    ConfigStore::Value(vtype, val.at("step")),
+                    std::move(neutral_setting),
+                    parse_scale_tables(control.key(), val)));
         }
         else if(ctrltype == "on_off")
             result.emplace(
                 control.key(),
                 std::make_unique<StaticModels::Elements::OnOff>(
-                    val, std::string(control.key()),
+                    std::move(roon), std::string(control.key()),
                     std::move(label), std::move(desc),
                     StaticModels::Utils::get<std::string>(val, "neutral_setting", "off")));
         else
             Error() << "Invalid control type \"" << ctrltype << "\"";
+
+        memo.emplace(std::move(memo_key), result.at(control.key()));
     }
 
     return result;
@@ -252,7 +577,7 @@ static DefinedElements parse_elements(const nlohmann::json &model)
         {
             auto src_obj =
                 std::make_unique<StaticModels::Elements::AudioSource>(
-                    src, std::string(src.at("id").get<std::string>()),
+                    std::string(src.at("id").get<std::string>()),
                     StaticModels::Utils::get<std::string>(src, "description", ""));
             const auto &key(src_obj->id_);
             elements.emplace(key, std::move(src_obj));
@@ -303,8 +628,9 @@ static DefinedElements parse_elements(const nlohmann::json &model)
         {
             auto sink_obj =
                 std::make_unique<StaticModels::Elements::AudioSink>(
-                    sink, std::string(sink.at("id").get<std::string>()),
-                    StaticModels::Utils::get<std::string>(sink, "description", ""));
+                    std::string(sink.at("id").get<std::string>()),
+                    StaticModels::Utils::get<std::string>(sink, "description", ""),
+                    parse_roon_sink(sink));
             const auto &key(sink_obj->id_);
             elements.emplace(key, std::move(sink_obj));
         }
@@ -317,13 +643,15 @@ static DefinedElements parse_elements(const nlohmann::json &model)
 
     try
     {
+        ControlsMemo memo;
+
         for(const auto &elem : model.at("elements"))
         {
             const auto &e(elem.at("element"));
-            auto controls(parse_controls(e));
+            auto controls(parse_controls(e, memo));
             auto elem_obj =
                 std::make_unique<StaticModels::Elements::Internal>(
-                    elem, std::string(elem.at("id").get<std::string>()),
+                    std::string(elem.at("id").get<std::string>()),
                     StaticModels::Utils::get<std::string>(e, "description", ""),
                     StaticModels::Utils::get<unsigned int>(e, "stereo_inputs", 1),
                     StaticModels::Utils::get<unsigned int>(e, "stereo_outputs", 1),
@@ -497,8 +825,8 @@ static void add_exceptions_to_mux_mapping(
     for(const auto &mapping : mapping_table.items())
     {
         const auto idx =
-            selector.to_selector_index(ConfigStore::Value(
-                ConfigStore::ValueType::VT_ASCIIZ, mapping.key()));
+            selector.to_selector_index(
+                ConfigStore::Value::mk_string(mapping.key()));
 
         if(m.size() <= idx)
             m.resize(idx + 1, StaticModels::SignalPaths::Input::mk_unconnected());
@@ -883,25 +1211,137 @@ static void add_parent_connections(StaticModels::SignalPaths::ApplianceBuilder &
     }
 }
 
-StaticModels::DeviceModel
-StaticModels::DeviceModel::mk_model(std::string &&name,
-                                    const nlohmann::json &definition)
+static StaticModels::SignalPaths::SignalTypes
+parse_signal_types(StaticModels::SignalPaths::ApplianceBuilder &b,
+                   const nlohmann::json &spec, const char *single,
+                   const char *multiple)
 {
-    auto defined_elements(parse_elements(definition));
-    const auto io_mappings(get_io_mappings_from_model(
-                                    definition, defined_elements, name));
+    StaticModels::SignalPaths::SignalTypes result = 0;
 
-    SignalPaths::ApplianceBuilder b(std::move(std::string(name)));
-    add_elements(b, defined_elements, io_mappings);
+    const auto one(spec.find(single));
+    if(one != spec.end())
+        result |= b.mk_signal_type(one->get<std::string>());
 
-    b.no_more_elements();
+    const auto many(spec.find(multiple));
+    if(many != spec.end())
+        for(const auto &t : *many)
+            result |= b.mk_signal_type(t.get<std::string>());
 
-    add_explicit_connections(b, definition, defined_elements, name);
-    add_parent_connections(b, defined_elements, name);
+    return result;
+}
 
-    return DeviceModel(std::move(name),
-                       std::move(defined_elements),
-                       SignalPaths::Appliance(std::move(b.build())));
+/*!
+ * Attach the signal types declared in the model to the path elements.
+ *
+ * The types are read from the optional "signal_types" array. Output types
+ * may be declared for specific outputs by appending the pad name to the
+ * element name (such as "input_select.out1").
+ */
+static void add_signal_types(StaticModels::SignalPaths::ApplianceBuilder &b,
+                             const nlohmann::json &model,
+                             const std::string &device_name)
+{
+    const auto it(model.find("signal_types"));
+    if(it == model.end())
+        return;
+
+    try
+    {
+        for(const auto &spec : *it)
+        {
+            const auto input_types(parse_signal_types(b, spec, "input_type",
+                                                      "input_types"));
+            const auto output_types(parse_signal_types(b, spec, "output_type",
+                                                       "output_types"));
+
+            for(const auto &elem_spec : spec.at("elements"))
+            {
+                const auto name_and_pad(StaticModels::Utils::split_qualified_name(
+                                            elem_spec.get<std::string>(), true));
+                StaticModels::SignalPaths::PathElement *elem;
+
+                try
+                {
+                    elem = &b.lookup_element(std::get<0>(name_and_pad));
+                }
+                catch(const std::out_of_range &e)
+                {
+                    Error()
+                        << "Undefined element \"" << std::get<0>(name_and_pad)
+                        << "\" in signal types of device \""
+                        << device_name << "\"";
+                }
+
+                if(std::get<1>(name_and_pad).empty())
+                {
+                    elem->declare_input_types(input_types);
+                    elem->declare_output_types(output_types);
+                    continue;
+                }
+
+                if(input_types != 0)
+                    Error()
+                        << "Input signal types cannot be declared for pad \""
+                        << elem_spec.get<std::string>() << "\" of device \""
+                        << device_name << "\"";
+
+                elem->declare_output_types(
+                    StaticModels::SignalPaths::Output(
+                        parse_pad_index(name_and_pad, false)),
+                    output_types);
+            }
+        }
+    }
+    catch(const std::exception &e)
+    {
+        msg_error(0, LOG_NOTICE, "%s", e.what());
+        throw;
+    }
+}
+
+/*!
+ * Read the optional "usb_connectors" array.
+ *
+ * Connectors must have an ID and a device path. Older models use "name"
+ * instead of "label", so this is accepted as well.
+ */
+static StaticModels::UsbConnectors
+parse_usb_connectors(const nlohmann::json &model, const std::string &device_name)
+{
+    std::vector<StaticModels::UsbConnector> result;
+
+    const auto it(model.find("usb_connectors"));
+    if(it == model.end())
+        return StaticModels::UsbConnectors(std::move(result));
+
+    try
+    {
+        for(const auto &conn : *it)
+        {
+            auto id(conn.at("id").get<std::string>());
+            auto device_path(conn.at("device_path").get<std::string>());
+
+            if(id.empty() || device_path.empty())
+                Error() << "USB connector with empty ID or device path in device \""
+                        << device_name << "\"";
+
+            auto label(StaticModels::Utils::get<std::string>(conn, "label", ""));
+            if(label.empty())
+                label = StaticModels::Utils::get<std::string>(conn, "name", "");
+
+            result.emplace_back(
+                std::move(id), std::move(label), std::move(device_path),
+                StaticModels::Utils::get<std::string>(conn, "location", ""),
+                StaticModels::Utils::get<std::string>(conn, "audio_source", ""));
+        }
+    }
+    catch(const std::exception &e)
+    {
+        msg_error(0, LOG_NOTICE, "%s", e.what());
+        throw;
+    }
+
+    return StaticModels::UsbConnectors(std::move(result));
 }
 
 static const StaticModels::Elements::Control *
@@ -930,18 +1370,86 @@ get_selector_control(
     return elem->get_control_ptr(control_id);
 }
 
+StaticModels::DeviceModel
+StaticModels::DeviceModel::mk_model(std::string &&name,
+                                    const nlohmann::json &definition,
+                                    const BuildPhaseFn &phase_done)
+{
+    const auto done =
+        [&phase_done] (const char *phase)
+        {
+            if(phase_done != nullptr)
+                phase_done(phase);
+        };
+
+    auto defined_elements(parse_elements(definition));
+    done("parse_elements");
+
+    const auto io_mappings(get_io_mappings_from_model(
+                                    definition, defined_elements, name));
+    done("get_io_mappings_from_model");
+
+    SignalPaths::ApplianceBuilder b(std::move(std::string(name)));
+    add_elements(b, defined_elements, io_mappings);
+
+    b.no_more_elements();
+    done("add_elements");
+
+    add_explicit_connections(b, definition, defined_elements, name);
+    done("add_explicit_connections");
+
+    add_parent_connections(b, defined_elements, name);
+    done("add_parent_connections");
+
+    add_signal_types(b, definition, name);
+    done("add_signal_types");
+
+    auto usb_connectors(parse_usb_connectors(definition, name));
+    done("parse_usb_connectors");
+
+    auto appliance(b.build());
+    done("ApplianceBuilder::build");
+
+    return DeviceModel(std::move(name),
+                       std::make_shared<Parts>(
+                           std::move(defined_elements),
+                           std::move(appliance),
+                           std::move(usb_connectors)));
+}
+
 bool StaticModels::DeviceModel::has_selector(const std::string &element_id,
                                              const std::string &control_id) const
 {
-    return get_selector_control(signal_path_, elements_,
+    return get_selector_control(parts_->signal_path_, parts_->elements_,
                                 element_id, control_id) != nullptr;
 }
 
+/*!
+ * Handle of the switching element selected by given control.
+ *
+ * The handle is looked up by element because identical controls are shared
+ * between elements, so that a control alone does not tell which switching
+ * element it selects.
+ *
+ * \returns
+ *     The handle, or an invalid handle if the control is not the selector of
+ *     a switching element.
+ */
+StaticModels::SignalPaths::SelectorHandle
+StaticModels::DeviceModel::get_selector_handle(const std::string &element_id,
+                                               const std::string &control_id) const
+{
+    const auto *sw_elem = parts_->signal_path_.lookup_switching_element(element_id);
+    return sw_elem != nullptr && sw_elem->get_selector_name() == control_id
+        ? sw_elem->get_selector_handle()
+        : SignalPaths::SelectorHandle::mk_invalid();
+}
+
 const StaticModels::Elements::Control *
 StaticModels::DeviceModel::get_selector_control_ptr(const std::string &element_id,
                                                     const std::string &control_id) const
 {
-    return get_selector_control(signal_path_, elements_,
+    return get_selector_control(parts_->signal_path_, parts_->elements_,
                                 element_id, control_id);
 }
 
@@ -949,8 +1457,8 @@ const StaticModels::Elements::Control *
 StaticModels::DeviceModel::get_control_by_name(const std::string &element_id,
                                                const std::string &control_id) const
 {
-    const auto found_elem(elements_.find(element_id));
-    if(found_elem == elements_.end())
+    const auto found_elem(parts_->elements_.find(element_id));
+    if(found_elem == parts_->elements_.end())
         return nullptr;
 
     const auto *elem =
@@ -970,9 +1478,23 @@ StaticModels::DeviceModel::to_selector_index(const std::string &element_id,
     if(ctrl == nullptr)
         return SignalPaths::Selector::mk_invalid();
 
+    return to_selector_index(*ctrl, element_id, control_id, value);
+}
+
+/*!
+ * Map value of a selector control to selector index.
+ *
+ * The element and control IDs are only used for error messages.
+ */
+StaticModels::SignalPaths::Selector
+StaticModels::DeviceModel::to_selector_index(const Elements::Control &ctrl,
+                                             const std::string &element_id,
+                                             const std::string &control_id,
+                                             const ConfigStore::Value &value) const
+{
     try
     {
-        return SignalPaths::Selector(ctrl->to_selector_index(value));
+        return SignalPaths::Selector(ctrl.to_selector_index(value));
     }
     catch(const std::exception &e)
     {
@@ -981,3 +1503,458 @@ StaticModels::DeviceModel::to_selector_index(const std::string &element_id,
         return SignalPaths::Selector::mk_invalid();
     }
 }
+
+/*!
+ * SHA-256 digest of a model definition in its compact JSON form.
+ *
+ * The definition hashes used for looking up models are not collision-free,
+ * so models are shared only if their digests match as well.
+ */
+StaticModels::DeviceModelCache::Digest
+StaticModels::DeviceModelCache::digest_definition(const nlohmann::json &definition)
+{
+    return Hashing::sha256(definition.dump());
+}
+
+/*!
+ * Find cached model built from an identical definition.
+ *
+ * Candidates are found by \p definition_hash. A model is returned only if
+ * its definition digest matches \p definition_digest as well, so that a
+ * collision of hashes never makes two different devices share a model.
+ */
+const StaticModels::DeviceModel *
+StaticModels::DeviceModelCache::find_model_by_hash(size_t definition_hash,
+                                                   const Digest &definition_digest) const
+{
+    const auto ids(ids_by_hash_.equal_range(definition_hash));
+
+    for(auto id = ids.first; id != ids.second; ++id)
+    {
+        const auto it(models_.find(id->second));
+
+        if(it != models_.end() && it->second.model_ != nullptr &&
+           it->second.definition_hash_ == definition_hash &&
+           it->second.definition_digest_ == definition_digest)
+            return it->second.model_.get();
+    }
+
+    return nullptr;
+}
+
+void StaticModels::DeviceModelCache::add_to_hash_index(const std::string &device_id,
+                                                       const Entry &entry)
+{
+    if(entry.model_ != nullptr &&
+       find_model_by_hash(entry.definition_hash_, entry.definition_digest_) == nullptr)
+        ids_by_hash_.emplace(entry.definition_hash_, device_id);
+}
+
+void StaticModels::DeviceModelCache::rebuild_hash_index()
+{
+    ids_by_hash_.clear();
+
+    for(const auto &it : models_)
+        add_to_hash_index(it.first, it.second);
+}
+
+/*!
+ * Number of models which do not share their parts with other models.
+ */
+size_t StaticModels::DeviceModelCache::get_number_of_distinct_models() const
+{
+    std::set<Digest> digests;
+
+    for(const auto &it : models_)
+        if(it.second.model_ != nullptr)
+            digests.insert(it.second.definition_digest_);
+
+    return digests.size();
+}
+
+/*!
+ * Build model from definition, or share parts with an identical model.
+ */
+static std::unique_ptr<StaticModels::DeviceModel>
+mk_model_or_alias(const std::string &device_id, const nlohmann::json &definition,
+                  const StaticModels::DeviceModel *identical)
+{
+    if(identical == nullptr)
+        return std::make_unique<StaticModels::DeviceModel>(
+                    StaticModels::DeviceModel::mk_model(std::string(device_id),
+                                                        definition));
+
+    msg_vinfo(MESSAGE_LEVEL_DEBUG,
+              "Model \"%s\" is identical to model \"%s\"",
+              device_id.c_str(), identical->name_.c_str());
+
+    return std::make_unique<StaticModels::DeviceModel>(
+                StaticModels::DeviceModel::mk_alias(std::string(device_id),
+                                                    *identical));
+}
+
+const StaticModels::DeviceModel *
+StaticModels::DeviceModelCache::get_device_model(const std::string &device_id)
+{
+    const auto dm(models_.find(device_id));
+    if(dm != models_.end())
+        return dm->second.model_.get();
+
+    const auto &definition(database_.get_device_model_definition(device_id));
+    const auto definition_hash(std::hash<nlohmann::json>{}(definition));
+    auto &entry(models_.emplace(device_id, Entry(definition_hash, Digest(), nullptr))
+                .first->second);
+
+    if(definition.is_null())
+    {
+        msg_error(0, LOG_NOTICE,
+                  "No model defined for device ID \"%s\"", device_id.c_str());
+        return nullptr;
+    }
+
+    try
+    {
+        entry.definition_digest_ = digest_definition(definition);
+        entry.model_ = mk_model_or_alias(device_id, definition,
+                                         find_model_by_hash(definition_hash,
+                                                            entry.definition_digest_));
+    }
+    catch(const std::exception &e)
+    {
+        msg_error(0, LOG_NOTICE, "%s", e.what());
+        models_.erase(device_id);
+        return nullptr;
+    }
+
+    add_to_hash_index(device_id, entry);
+
+    if(release_definitions_)
+        database_.release_definition(device_id);
+
+    return entry.model_.get();
+}
+
+/*!
+ * Build all models defined in the database which are not in the cache yet.
+ *
+ * Models are built in parallel on up to \p number_of_threads threads. The
+ * time it took to build each model is logged. Models which fail to build are
+ * not cached, so that they are built and reported again on first use.
+ *
+ * The caller must make sure that neither the database nor the cache are used
+ * by any other thread while this function is running.
+ *
+ * \returns
+ *     Number of models which have been built and added to the cache.
+ */
+size_t StaticModels::DeviceModelCache::prebuild(unsigned int number_of_threads)
+{
+    struct Job
+    {
+        const std::string device_id_;
+        const nlohmann::json &definition_;
+        const size_t definition_hash_;
+        const Digest definition_digest_;
+        const bool is_duplicate_;
+        std::unique_ptr<DeviceModel> model_;
+        std::string error_;
+        std::chrono::microseconds duration_;
+
+        explicit Job(const std::string &device_id,
+                     const nlohmann::json &definition,
+                     size_t definition_hash, const Digest &definition_digest,
+                     bool is_duplicate):
+            device_id_(device_id),
+            definition_(definition),
+            definition_hash_(definition_hash),
+            definition_digest_(definition_digest),
+            is_duplicate_(is_duplicate),
+            duration_(0)
+        {}
+    };
+
+    /* collect definitions in this thread, the database is not thread-safe;
+     * duplicate definitions are not built, but share the built parts */
+    std::vector<Job> jobs;
+    std::set<Digest> seen_digests;
+    database_.for_each_device_id(
+        [this, &jobs, &seen_digests] (const std::string &device_id)
+        {
+            if(models_.find(device_id) != models_.end())
+                return;
+
+            const auto &definition(database_.get_device_model_definition(device_id));
+            const auto definition_hash(std::hash<nlohmann::json>{}(definition));
+            const auto definition_digest(digest_definition(definition));
+            const bool is_duplicate =
+                !seen_digests.insert(definition_digest).second ||
+                find_model_by_hash(definition_hash, definition_digest) != nullptr;
+            jobs.emplace_back(device_id, definition, definition_hash,
+                              definition_digest, is_duplicate);
+        });
+
+    if(jobs.empty())
+        return 0;
+
+    std::atomic<size_t> next_job(0);
+    const auto worker =
+        [&jobs, &next_job] ()
+        {
+            for(size_t i = next_job++; i < jobs.size(); i = next_job++)
+            {
+                auto &job(jobs[i]);
+
+                if(job.is_duplicate_)
+                    continue;
+
+                const auto start(std::chrono::steady_clock::now());
+
+                try
+                {
+                    job.model_ = std::make_unique<DeviceModel>(
+                            DeviceModel::mk_model(std::string(job.device_id_),
+                                                  job.definition_));
+                }
+                catch(const std::exception &e)
+                {
+                    job.error_ = e.what();
+                }
+
+                job.duration_ =
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start);
+            }
+        };
+
+    number_of_threads = std::max(1U, std::min<unsigned int>(number_of_threads,
+                                                            jobs.size()));
+    std::vector<std::thread> threads;
+
+    /* failing to start a thread leaves more work for the others, but any
+     * exception must not pass by the threads already running */
+    for(unsigned int i = 1; i < number_of_threads; ++i)
+    {
+        try
+        {
+            threads.emplace_back(worker);
+        }
+        catch(const std::system_error &e)
+        {
+            msg_error(0, LOG_NOTICE,
+                      "Prebuilding device models with %zu threads only: %s",
+                      threads.size() + 1, e.what());
+            break;
+        }
+    }
+
+    worker();
+
+    for(auto &t : threads)
+        t.join();
+
+    size_t count = 0;
+
+    for(auto &job : jobs)
+    {
+        if(job.is_duplicate_)
+        {
+            const auto *identical = find_model_by_hash(job.definition_hash_,
+                                                       job.definition_digest_);
+
+            if(identical == nullptr)
+            {
+                msg_error(0, LOG_NOTICE,
+                          "Failed building model \"%s\": identical model failed",
+                          job.device_id_.c_str());
+                continue;
+            }
+
+            job.model_ = mk_model_or_alias(job.device_id_, job.definition_,
+                                           identical);
+        }
+        else if(job.model_ == nullptr)
+        {
+            msg_error(0, LOG_NOTICE, "Failed building model \"%s\": %s",
+                      job.device_id_.c_str(), job.error_.c_str());
+            continue;
+        }
+        else
+            msg_info("Built model \"%s\" in %lld us",
+                     job.device_id_.c_str(), (long long)job.duration_.count());
+
+        const auto added(models_.emplace(job.device_id_,
+                                         Entry(job.definition_hash_,
+                                               job.definition_digest_,
+                                               std::move(job.model_))));
+        add_to_hash_index(added.first->first, added.first->second);
+        ++count;
+
+        if(release_definitions_)
+            database_.release_definition(job.device_id_);
+    }
+
+    return count;
+}
+
+/*!
+ * Drop all models whose definitions have changed in the database.
+ *
+ * The caller must make sure that no pointers to dropped models are in use
+ * anymore.
+ *
+ * \returns
+ *     Number of models which have been dropped from the cache.
+ */
+size_t StaticModels::DeviceModelCache::sync_with_database()
+{
+    size_t dropped = 0;
+
+    for(auto it = models_.begin(); it != models_.end(); /* nothing */)
+    {
+        if(database_.get_definition_hash(it->first) == it->second.definition_hash_)
+            ++it;
+        else
+        {
+            it = models_.erase(it);
+            ++dropped;
+        }
+    }
+
+    if(dropped > 0)
+        rebuild_hash_index();
+
+    return dropped;
+}
+
+/*!
+ * Hashes over the definitions of all cached models.
+ *
+ * Pass the result to #StaticModels::DeviceModelCache::rebuild_changed().
+ */
+std::unordered_map<std::string, size_t>
+StaticModels::DeviceModelCache::get_definition_hashes() const
+{
+    std::unordered_map<std::string, size_t> result;
+
+    for(const auto &it : models_)
+        result.emplace(it.first, it.second.definition_hash_);
+
+    return result;
+}
+
+/*!
+ * Build models whose definitions differ from those in a running cache.
+ *
+ * Only models which are in \p hashes are considered, all other models will be
+ * built on demand after the reload. This function does not touch any cache,
+ * so it may be called on any thread as long as \p reload is not shared.
+ *
+ * \param reload
+ *     Object containing the freshly loaded database, receives the rebuilt
+ *     models.
+ *
+ * \param hashes
+ *     Definition hashes as returned by
+ *     #StaticModels::DeviceModelCache::get_definition_hashes().
+ *
+ * \returns
+ *     Number of models which have been rebuilt.
+ */
+size_t StaticModels::DeviceModelCache::rebuild_changed(
+        Reload &reload, const std::unordered_map<std::string, size_t> &hashes)
+{
+    size_t count = 0;
+    std::map<Digest, const DeviceModel *> rebuilt_by_digest;
+
+    for(const auto &it : hashes)
+    {
+        const auto &definition(reload.database_.get_device_model_definition(it.first));
+        const auto definition_hash(std::hash<nlohmann::json>{}(definition));
+
+        if(definition_hash == it.second)
+            continue;
+
+        if(definition.is_null())
+        {
+            msg_error(0, LOG_NOTICE,
+                      "No model defined for device ID \"%s\" anymore",
+                      it.first.c_str());
+            reload.models_.emplace(it.first, Entry(definition_hash, Digest(), nullptr));
+            continue;
+        }
+
+        const auto definition_digest(digest_definition(definition));
+        const auto identical(rebuilt_by_digest.find(definition_digest));
+
+        try
+        {
+            const auto &entry(
+                reload.models_.emplace(
+                    it.first,
+                    Entry(definition_hash, definition_digest,
+                          mk_model_or_alias(it.first, definition,
+                                            identical != rebuilt_by_digest.end()
+                                            ? identical->second
+                                            : nullptr)))
+                .first->second);
+            rebuilt_by_digest.emplace(definition_digest, entry.model_.get());
+            msg_info("Rebuilt model \"%s\"", it.first.c_str());
+            ++count;
+        }
+        catch(const std::exception &e)
+        {
+            msg_error(0, LOG_NOTICE, "Failed rebuilding model \"%s\": %s",
+                      it.first.c_str(), e.what());
+        }
+    }
+
+    return count;
+}
+
+/*!
+ * Replace database and changed models by reloaded ones.
+ *
+ * Models rebuilt by #StaticModels::DeviceModelCache::rebuild_changed() replace
+ * their cached counterparts. Cached models whose definitions have changed, but
+ * which have not been rebuilt, are dropped from the cache. Unchanged models
+ * are kept as they are.
+ *
+ * \returns
+ *     The replaced models. These must be kept alive until all users have been
+ *     switched over to the new models (see
+ *     #ConfigStore::Settings::reattach_models()).
+ */
+std::vector<std::unique_ptr<StaticModels::DeviceModel>>
+StaticModels::DeviceModelCache::swap_in(Reload &&reload)
+{
+    database_ = std::move(reload.database_);
+
+    std::vector<std::unique_ptr<DeviceModel>> replaced;
+
+    for(auto it = models_.begin(); it != models_.end(); /* nothing */)
+    {
+        auto rebuilt(reload.models_.find(it->first));
+
+        if(rebuilt != reload.models_.end())
+        {
+            replaced.emplace_back(std::move(it->second.model_));
+            it->second = std::move(rebuilt->second);
+        }
+        else if(database_.get_definition_hash(it->first) != it->second.definition_hash_)
+        {
+            replaced.emplace_back(std::move(it->second.model_));
+            it = models_.erase(it);
+            continue;
+        }
+
+        if(release_definitions_ && it->second.model_ != nullptr)
+            database_.release_definition(it->first);
+
+        ++it;
+    }
+
+    reload.models_.clear();
+    rebuild_hash_index();
+
+    return replaced;
+}
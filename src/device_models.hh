@@ -24,10 +24,13 @@
 
 #include "element.hh"
 #include "signal_paths.hh"
+#include "sha256.hh"
 
 namespace StaticModels
 {
 
+class CompiledModels;
+
 /*!
  * All models as read from the JSON database.
  *
@@ -39,6 +42,12 @@ class DeviceModelsDatabase
   private:
     nlohmann::json config_data_;
 
+    /* set if loaded via #StaticModels::DeviceModelsDatabase::load_compiled() */
+    std::shared_ptr<CompiledModels> compiled_;
+
+    /* hashes of definitions dropped by #release_definition() */
+    std::unordered_map<std::string, size_t> released_;
+
   public:
     DeviceModelsDatabase(const DeviceModelsDatabase &) = delete;
     DeviceModelsDatabase(DeviceModelsDatabase &&) = default;
@@ -50,7 +59,125 @@ class DeviceModelsDatabase
     bool load(const char *config, bool suppress_error = false);
     bool loads(const std::string &js, bool suppress_error = false);
     void flatten();
+
+    /*!
+     * Load flattened models from compiled file, compile it if necessary.
+     *
+     * The compiled file contains an index of the flattened model definitions,
+     * tagged with a hash over the contents of the JSON source file. If the
+     * hash matches, the file is memory-mapped and each definition is parsed
+     * only when it is requested for the first time. Otherwise, the JSON file
+     * is parsed and flattened, and the compiled file is rewritten. There is
+     * no need to call #flatten() after this function.
+     */
+    bool load_compiled(const std::string &config, const std::string &compiled,
+                       bool suppress_error = false);
+    bool compile(const std::string &compiled, uint64_t source_hash) const;
+    static uint64_t hash_source(const char *source, size_t length);
     const nlohmann::json &get_device_model_definition(const std::string &device_id) const;
+    size_t get_definition_hash(const std::string &device_id) const;
+    void release_definition(const std::string &device_id);
+    void for_each_device_id(const std::function<void(const std::string &)> &apply) const;
+
+  private:
+    const nlohmann::json &get_compiled_definition(const std::string &device_id) const;
+    void release_compiled_definition(const std::string &device_id);
+    void for_each_compiled_device_id(const std::function<void(const std::string &)> &apply) const;
+};
+
+/*!
+ * USB port of an appliance, as declared in its "usb_connectors".
+ *
+ * Each connector is identified by the sysfs path of the USB device plugged
+ * into it, and may feed an audio source of the appliance.
+ */
+class UsbConnector
+{
+  public:
+    const std::string id_;
+    const std::string label_;
+    const std::string device_path_;
+    const std::string location_;
+    const std::string audio_source_;
+
+    UsbConnector(const UsbConnector &) = delete;
+    UsbConnector(UsbConnector &&) = default;
+    UsbConnector &operator=(const UsbConnector &) = delete;
+    UsbConnector &operator=(UsbConnector &&) = default;
+
+    explicit UsbConnector(std::string &&id, std::string &&label,
+                          std::string &&device_path, std::string &&location,
+                          std::string &&audio_source):
+        id_(std::move(id)),
+        label_(std::move(label)),
+        device_path_(std::move(device_path)),
+        location_(std::move(location)),
+        audio_source_(std::move(audio_source))
+    {}
+};
+
+/*!
+ * All USB connectors of an appliance, indexed by device path and audio source.
+ *
+ * Device paths and audio sources should be unique within a model. If they are
+ * not, then the first connector wins, except that connectors without audio
+ * source never shadow connectors with audio source.
+ */
+class UsbConnectors
+{
+  private:
+    std::vector<UsbConnector> connectors_;
+    std::unordered_map<std::string, size_t> by_device_path_;
+    std::unordered_map<std::string, size_t> by_audio_source_;
+
+  public:
+    UsbConnectors(const UsbConnectors &) = delete;
+    UsbConnectors(UsbConnectors &&) = default;
+    UsbConnectors &operator=(const UsbConnectors &) = delete;
+    UsbConnectors &operator=(UsbConnectors &&) = default;
+
+    explicit UsbConnectors(std::vector<UsbConnector> &&connectors):
+        connectors_(std::move(connectors))
+    {
+        for(size_t i = 0; i < connectors_.size(); ++i)
+        {
+            const auto &c(connectors_[i]);
+
+            if(c.audio_source_.empty())
+            {
+                by_device_path_.emplace(c.device_path_, i);
+                continue;
+            }
+
+            const auto it(by_device_path_.find(c.device_path_));
+            if(it == by_device_path_.end())
+                by_device_path_.emplace(c.device_path_, i);
+            else if(connectors_[it->second].audio_source_.empty())
+                it->second = i;
+
+            by_audio_source_.emplace(c.audio_source_, i);
+        }
+    }
+
+    const UsbConnector *lookup_by_device_path(const std::string &device_path) const
+    {
+        const auto it(by_device_path_.find(device_path));
+        return it != by_device_path_.end() ? &connectors_[it->second] : nullptr;
+    }
+
+    const UsbConnector *lookup_by_audio_source(const std::string &audio_source) const
+    {
+        const auto it(by_audio_source_.find(audio_source));
+        return it != by_audio_source_.end() ? &connectors_[it->second] : nullptr;
+    }
+
+    void for_each(const std::function<void(const UsbConnector &)> &apply) const
+    {
+        for(const auto &c : connectors_)
+            apply(c);
+    }
+
+    size_t size() const { return connectors_.size(); }
 };
 
 /*!
@@ -62,16 +189,36 @@ class DeviceModel
     const std::string name_;
 
   private:
-    std::unordered_map<std::string, std::unique_ptr<Elements::Element>> elements_;
-    SignalPaths::Appliance signal_path_;
+    /*!
+     * The expensive parts of a model, shared by models built from identical
+     * definitions.
+     */
+    struct Parts
+    {
+        const std::unordered_map<std::string, std::unique_ptr<Elements::Element>> elements_;
+        const SignalPaths::Appliance signal_path_;
+        const UsbConnectors usb_connectors_;
+
+        Parts(const Parts &) = delete;
+        Parts(Parts &&) = default;
+        Parts &operator=(const Parts &) = delete;
+        Parts &operator=(Parts &&) = default;
 
-    explicit DeviceModel(
-            std::string &&name,
-            std::unordered_map<std::string, std::unique_ptr<Elements::Element>> &&elements,
-            SignalPaths::Appliance &&signal_path):
+        explicit Parts(
+                std::unordered_map<std::string, std::unique_ptr<Elements::Element>> &&elements,
+                SignalPaths::Appliance &&signal_path,
+                UsbConnectors &&usb_connectors):
+            elements_(std::move(elements)),
+            signal_path_(std::move(signal_path)),
+            usb_connectors_(std::move(usb_connectors))
+        {}
+    };
+
+    std::shared_ptr<const Parts> parts_;
+
+    explicit DeviceModel(std::string &&name, std::shared_ptr<const Parts> parts):
         name_(std::move(name)),
-        elements_(std::move(elements)),
-        signal_path_(std::move(signal_path))
+        parts_(std::move(parts))
     {}
 
   public:
@@ -80,17 +227,38 @@ class DeviceModel
     DeviceModel &operator=(const DeviceModel &) = delete;
     DeviceModel &operator=(DeviceModel &&) = default;
 
-    static DeviceModel mk_model(std::string &&name, const nlohmann::json &definition);
+    /*!
+     * Called after each phase of #mk_model() with the name of the phase.
+     */
+    using BuildPhaseFn = std::function<void(const char *phase)>;
+
+    static DeviceModel mk_model(std::string &&name, const nlohmann::json &definition,
+                                const BuildPhaseFn &phase_done = nullptr);
+
+    /*!
+     * Create model for another device ID with identical definition.
+     *
+     * The new model shares elements and signal path graph with \p model.
+     */
+    static DeviceModel mk_alias(std::string &&name, const DeviceModel &model)
+    {
+        return DeviceModel(std::move(name), model.parts_);
+    }
+
+    bool shares_parts_with(const DeviceModel &other) const
+    {
+        return parts_ == other.parts_;
+    }
 
     void for_each_element(const std::function<void(const Elements::Element &)> &apply) const
     {
-        for(const auto &elem : elements_)
+        for(const auto &elem : parts_->elements_)
             apply(*elem.second);
     }
 
     const Elements::Element *lookup_element(const std::string &element_id) const
     {
-        const auto &elem(elements_.find(element_id));
+        const auto &elem(parts_->elements_.find(element_id));
         return elem->second->id_ == element_id ? elem->second.get() : nullptr;
     }
 
@@ -101,8 +269,8 @@ class DeviceModel
 
     const Elements::AudioSink *get_audio_sink(const std::string &sink_name) const
     {
-        const auto &it(elements_.find(sink_name));
-        return it != elements_.end()
+        const auto &it(parts_->elements_.find(sink_name));
+        return it != parts_->elements_.end()
             ? dynamic_cast<const Elements::AudioSink *>(it->second.get())
             : nullptr;
     }
@@ -111,6 +279,13 @@ class DeviceModel
     SignalPaths::Selector to_selector_index(const std::string &element_id,
                                             const std::string &control_id,
                                             const ConfigStore::Value &value) const;
+    SignalPaths::Selector to_selector_index(const Elements::Control &ctrl,
+                                            const std::string &element_id,
+                                            const std::string &control_id,
+                                            const ConfigStore::Value &value) const;
+
+    SignalPaths::SelectorHandle get_selector_handle(const std::string &element_id,
+                                                    const std::string &control_id) const;
     const StaticModels::Elements::Control *
     get_selector_control_ptr(const std::string &element_id,
                              const std::string &control_id) const;
@@ -118,7 +293,123 @@ class DeviceModel
     get_control_by_name(const std::string &element_id,
                         const std::string &control_id) const;
 
-    const SignalPaths::Appliance &get_signal_path_graph() const { return signal_path_; }
+    const SignalPaths::Appliance &get_signal_path_graph() const { return parts_->signal_path_; }
+    const UsbConnectors &get_usb_connectors() const { return parts_->usb_connectors_; }
+};
+
+/*!
+ * Device models built on demand from a #StaticModels::DeviceModelsDatabase.
+ *
+ * Building a model from its JSON definition is expensive, so each model is
+ * built only once and kept around for as long as the database lives. The
+ * cache is meant to be owned next to the database, not by the settings store,
+ * so that clearing the settings store only drops instance data.
+ *
+ * Each entry remembers a hash over the model definition it has been built
+ * from. Entries whose definition has changed in the database are dropped by
+ * #StaticModels::DeviceModelCache::sync_with_database(). The hash is also
+ * used to find models with identical definitions (such as devices which copy
+ * all their properties from another device); these are built only once and
+ * share their elements and signal path graph. An index over the hashes keeps
+ * this lookup independent of the number of cached models.
+ *
+ * Device IDs without model definition are cached as well, so that they are
+ * logged only once.
+ *
+ * Optionally, the JSON definition of each model is released from the database
+ * as soon as the model has been built. The models do not refer to their JSON
+ * definitions, so this reduces memory consumption to what is actually needed
+ * at runtime. Note that with a database loaded from plain JSON, models
+ * dropped from the cache cannot be built again without reloading the
+ * database.
+ */
+class DeviceModelCache
+{
+  private:
+    /* SHA-256 over a compact model definition */
+    using Digest = Hashing::SHA256Digest;
+
+    struct Entry
+    {
+        size_t definition_hash_;
+        Digest definition_digest_;
+        std::unique_ptr<DeviceModel> model_;
+
+        explicit Entry(size_t definition_hash, const Digest &definition_digest,
+                       std::unique_ptr<DeviceModel> model):
+            definition_hash_(definition_hash),
+            definition_digest_(definition_digest),
+            model_(std::move(model))
+        {}
+    };
+
+  public:
+    /*!
+     * Reloaded database and the models rebuilt from it.
+     *
+     * Filled by #StaticModels::DeviceModelCache::rebuild_changed() on any
+     * thread, then applied by #StaticModels::DeviceModelCache::swap_in().
+     */
+    class Reload
+    {
+      public:
+        DeviceModelsDatabase database_;
+
+      private:
+        friend DeviceModelCache;
+        std::unordered_map<std::string, Entry> models_;
+
+      public:
+        Reload(const Reload &) = delete;
+        Reload(Reload &&) = default;
+        Reload &operator=(const Reload &) = delete;
+        Reload &operator=(Reload &&) = default;
+        explicit Reload() = default;
+
+        size_t size() const { return models_.size(); }
+    };
+
+  private:
+
+    DeviceModelsDatabase &database_;
+    const bool release_definitions_;
+    std::unordered_map<std::string, Entry> models_;
+
+    /* device ID of one built model per distinct definition, looked up by
+     * hash and told apart by digest */
+    std::unordered_multimap<size_t, std::string> ids_by_hash_;
+
+  public:
+    DeviceModelCache(const DeviceModelCache &) = delete;
+    DeviceModelCache(DeviceModelCache &&) = default;
+    DeviceModelCache &operator=(const DeviceModelCache &) = delete;
+    DeviceModelCache &operator=(DeviceModelCache &&) = delete;
+
+    explicit DeviceModelCache(DeviceModelsDatabase &database,
+                              bool release_definitions = false):
+        database_(database),
+        release_definitions_(release_definitions)
+    {}
+
+    const DeviceModelsDatabase &get_database() const { return database_; }
+
+    const DeviceModel *get_device_model(const std::string &device_id);
+    size_t prebuild(unsigned int number_of_threads);
+    size_t sync_with_database();
+    std::unordered_map<std::string, size_t> get_definition_hashes() const;
+    static size_t rebuild_changed(Reload &reload,
+                                  const std::unordered_map<std::string, size_t> &hashes);
+    std::vector<std::unique_ptr<DeviceModel>> swap_in(Reload &&reload);
+    void clear() { models_.clear(); ids_by_hash_.clear(); }
+    size_t size() const { return models_.size(); }
+    size_t get_number_of_distinct_models() const;
+
+  private:
+    static Digest digest_definition(const nlohmann::json &definition);
+    const DeviceModel *find_model_by_hash(size_t definition_hash,
+                                          const Digest &definition_digest) const;
+    void add_to_hash_index(const std::string &device_id, const Entry &entry);
+    void rebuild_hash_index();
 };
 
 }
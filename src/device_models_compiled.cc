@@ -0,0 +1,390 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "device_models.hh"
+#include "messages.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ * Layout of a compiled models file:
+ *
+ *     CompiledHeader
+ *     CompiledIndexEntry[number_of_devices_], sorted by device ID
+ *     device IDs and model definitions (compact JSON), not terminated
+ *
+ * All offsets are relative to the beginning of the file.
+ */
+struct CompiledHeader
+{
+    char magic_[8];
+    uint32_t version_;
+    uint32_t header_size_;
+    uint64_t source_hash_;
+    uint32_t number_of_devices_;
+    uint32_t reserved_;
+};
+
+struct CompiledIndexEntry
+{
+    uint32_t id_offset_;
+    uint32_t id_length_;
+    uint32_t definition_offset_;
+    uint32_t definition_length_;
+};
+
+static constexpr char COMPILED_MAGIC[8] = { 'A', 'u', 'P', 'a', 'D', 'M', 'D', 'B' };
+
+/* increment whenever the file format or the way models are flattened
+ * changes (version 2: predefined elements are expanded) */
+static constexpr uint32_t COMPILED_VERSION = 2;
+
+uint64_t StaticModels::DeviceModelsDatabase::hash_source(const char *source,
+                                                         size_t length)
+{
+    /* FNV-1a, 64 bits */
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+
+    for(size_t i = 0; i < length; ++i)
+    {
+        hash ^= uint8_t(source[i]);
+        hash *= UINT64_C(0x100000001b3);
+    }
+
+    return hash;
+}
+
+class MappedFile
+{
+  private:
+    const char *data_;
+    size_t size_;
+
+  public:
+    MappedFile(const MappedFile &) = delete;
+    MappedFile(MappedFile &&) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile &operator=(MappedFile &&) = delete;
+
+    explicit MappedFile(const std::string &path):
+        data_(nullptr),
+        size_(0)
+    {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if(fd < 0)
+            return;
+
+        struct stat st;
+        if(fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void *mem = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mem != MAP_FAILED)
+            {
+                data_ = static_cast<const char *>(mem);
+                size_ = st.st_size;
+            }
+        }
+
+        close(fd);
+    }
+
+    ~MappedFile()
+    {
+        if(data_ != nullptr)
+            munmap(const_cast<char *>(data_), size_);
+    }
+
+    bool is_valid() const { return data_ != nullptr; }
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+};
+
+/*!
+ * Memory-mapped compiled models file.
+ *
+ * Model definitions are parsed when they are requested for the first time.
+ * Devices with identical definitions share the same parsed definition.
+ */
+class StaticModels::CompiledModels
+{
+  private:
+    MappedFile file_;
+    const CompiledIndexEntry *index_;
+    uint32_t number_of_devices_;
+    /* parsed definitions by offset in file */
+    mutable std::unordered_map<uint32_t, nlohmann::json> definitions_;
+
+  public:
+    CompiledModels(const CompiledModels &) = delete;
+    CompiledModels(CompiledModels &&) = delete;
+    CompiledModels &operator=(const CompiledModels &) = delete;
+    CompiledModels &operator=(CompiledModels &&) = delete;
+
+    explicit CompiledModels(const std::string &compiled):
+        file_(compiled),
+        index_(nullptr),
+        number_of_devices_(0)
+    {}
+
+    bool open(uint64_t source_hash)
+    {
+        if(!file_.is_valid() || file_.size() < sizeof(CompiledHeader))
+            return false;
+
+        CompiledHeader header;
+        std::memcpy(&header, file_.data(), sizeof(header));
+
+        if(std::memcmp(header.magic_, COMPILED_MAGIC, sizeof(header.magic_)) != 0 ||
+           header.version_ != COMPILED_VERSION ||
+           header.header_size_ != sizeof(header) ||
+           header.source_hash_ != source_hash ||
+           (file_.size() - sizeof(header)) / sizeof(CompiledIndexEntry) <
+           header.number_of_devices_)
+            return false;
+
+        index_ = reinterpret_cast<const CompiledIndexEntry *>(file_.data() +
+                                                              sizeof(header));
+
+        for(uint32_t i = 0; i < header.number_of_devices_; ++i)
+            if(!is_in_file(index_[i].id_offset_, index_[i].id_length_) ||
+               !is_in_file(index_[i].definition_offset_, index_[i].definition_length_))
+                return false;
+
+        number_of_devices_ = header.number_of_devices_;
+        return true;
+    }
+
+    const nlohmann::json &get_definition(const std::string &device_id) const
+    {
+        const auto *entry = find_entry(device_id);
+
+        if(entry == nullptr)
+        {
+            static const nlohmann::json empty;
+            return empty;
+        }
+
+        const auto found(definitions_.find(entry->definition_offset_));
+        if(found != definitions_.end())
+            return found->second;
+
+        const char *def = file_.data() + entry->definition_offset_;
+        return definitions_.emplace(
+                    entry->definition_offset_,
+                    nlohmann::json::parse(def, def + entry->definition_length_))
+               .first->second;
+    }
+
+    void release(const std::string &device_id)
+    {
+        const auto *entry = find_entry(device_id);
+        if(entry != nullptr)
+            definitions_.erase(entry->definition_offset_);
+    }
+
+    void for_each_device_id(const std::function<void(const std::string &)> &apply) const
+    {
+        for(uint32_t i = 0; i < number_of_devices_; ++i)
+            apply(std::string(get_id(index_[i])));
+    }
+
+  private:
+    const CompiledIndexEntry *find_entry(const std::string &device_id) const
+    {
+        const auto *const index_end = index_ + number_of_devices_;
+        const auto *entry =
+            std::lower_bound(index_, index_end, device_id,
+                [this] (const CompiledIndexEntry &e, const std::string &id)
+                { return get_id(e) < id; });
+
+        return entry != index_end && get_id(*entry) == device_id
+            ? entry
+            : nullptr;
+    }
+
+    bool is_in_file(uint32_t offset, uint32_t length) const
+    {
+        return offset <= file_.size() && length <= file_.size() - offset;
+    }
+
+    std::string_view get_id(const CompiledIndexEntry &e) const
+    {
+        return std::string_view(file_.data() + e.id_offset_, e.id_length_);
+    }
+};
+
+bool StaticModels::DeviceModelsDatabase::compile(const std::string &compiled,
+                                                 uint64_t source_hash) const
+{
+    std::vector<std::pair<std::string, std::string>> devices;
+
+    if(config_data_.find("all_devices") != config_data_.end())
+        for(const auto &device : config_data_["all_devices"].items())
+            devices.emplace_back(device.key(), device.value().dump());
+
+    std::sort(devices.begin(), devices.end());
+
+    CompiledHeader header {};
+    std::memcpy(header.magic_, COMPILED_MAGIC, sizeof(header.magic_));
+    header.version_ = COMPILED_VERSION;
+    header.header_size_ = sizeof(header);
+    header.source_hash_ = source_hash;
+    header.number_of_devices_ = devices.size();
+
+    /* identical definitions are stored only once */
+    std::vector<CompiledIndexEntry> index;
+    std::unordered_map<std::string_view, uint32_t> definition_offsets;
+    std::vector<bool> is_definition_stored;
+    uint32_t offset = sizeof(header) + devices.size() * sizeof(CompiledIndexEntry);
+
+    for(const auto &dev : devices)
+    {
+        CompiledIndexEntry e;
+        e.id_offset_ = offset;
+        e.id_length_ = dev.first.size();
+        offset += e.id_length_;
+        e.definition_length_ = dev.second.size();
+
+        const auto stored(definition_offsets.emplace(dev.second, offset));
+        e.definition_offset_ = stored.first->second;
+        is_definition_stored.push_back(stored.second);
+
+        if(stored.second)
+            offset += e.definition_length_;
+
+        index.push_back(e);
+    }
+
+    const std::string temp_name(compiled + ".tmp");
+
+    {
+        std::ofstream out(temp_name, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(index.data()),
+                  index.size() * sizeof(CompiledIndexEntry));
+
+        for(size_t i = 0; i < devices.size(); ++i)
+        {
+            out << devices[i].first;
+
+            if(is_definition_stored[i])
+                out << devices[i].second;
+        }
+
+        if(!out.flush())
+        {
+            msg_error(0, LOG_ERR, "Failed writing compiled models file \"%s\"",
+                      temp_name.c_str());
+            out.close();
+            std::remove(temp_name.c_str());
+            return false;
+        }
+    }
+
+    if(std::rename(temp_name.c_str(), compiled.c_str()) != 0)
+    {
+        msg_error(errno, LOG_ERR, "Failed renaming \"%s\" to \"%s\"",
+                  temp_name.c_str(), compiled.c_str());
+        std::remove(temp_name.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool StaticModels::DeviceModelsDatabase::load_compiled(const std::string &config,
+                                                       const std::string &compiled,
+                                                       bool suppress_error)
+{
+    compiled_ = nullptr;
+    released_.clear();
+    config_data_ = nlohmann::json();
+
+    const MappedFile source(config);
+
+    if(!source.is_valid())
+    {
+        if(!suppress_error)
+            msg_error(0, LOG_ERR,
+                      "Failed reading models configuration file \"%s\"",
+                      config.c_str());
+
+        return false;
+    }
+
+    const auto source_hash(hash_source(source.data(), source.size()));
+
+    auto models(std::make_shared<CompiledModels>(compiled));
+    if(models->open(source_hash))
+    {
+        compiled_ = std::move(models);
+        return true;
+    }
+
+    msg_info("Compiling models from \"%s\" to \"%s\"",
+             config.c_str(), compiled.c_str());
+
+    try
+    {
+        config_data_ = nlohmann::json::parse(source.data(),
+                                             source.data() + source.size());
+    }
+    catch(const std::exception &e)
+    {
+        msg_error(0, LOG_ERR, "%s", e.what());
+        config_data_ = nlohmann::json();
+        return false;
+    }
+
+    flatten();
+    compile(compiled, source_hash);
+
+    return true;
+}
+
+const nlohmann::json &
+StaticModels::DeviceModelsDatabase::get_compiled_definition(const std::string &device_id) const
+{
+    return compiled_->get_definition(device_id);
+}
+
+void StaticModels::DeviceModelsDatabase::release_compiled_definition(const std::string &device_id)
+{
+    compiled_->release(device_id);
+}
+
+void StaticModels::DeviceModelsDatabase::for_each_compiled_device_id(
+        const std::function<void(const std::string &)> &apply) const
+{
+    compiled_->for_each_device_id(apply);
+}
@@ -26,6 +26,7 @@
 
 #include <unordered_map>
 #include <string>
+#include <limits>
 
 namespace StaticModels
 {
@@ -38,14 +39,11 @@ class Element
   public:
     const std::string id_;
     const std::string description_;
-    const nlohmann::json &original_definition_;
 
   protected:
-    explicit Element(const nlohmann::json &original_definition,
-                     std::string &&id, std::string description):
+    explicit Element(std::string &&id, std::string description):
         id_(std::move(id)),
-        description_(std::move(description)),
-        original_definition_(original_definition)
+        description_(std::move(description))
     {}
 
   public:
@@ -70,9 +68,8 @@ class AudioSource: public Element
     AudioSource &operator=(const AudioSource &) = delete;
     AudioSource &operator=(AudioSource &&) = default;
 
-    explicit AudioSource(const nlohmann::json &original_definition,
-                         std::string &&id, std::string &&description):
-        Element(original_definition, std::move(id), std::move(description)),
+    explicit AudioSource(std::string &&id, std::string &&description):
+        Element(std::move(id), std::move(description)),
         parent_source_(nullptr)
     {}
 
@@ -93,17 +90,49 @@ class AudioSource: public Element
     const AudioSource *get_parent_source() const { return parent_source_; }
 };
 
+/*!
+ * Roon-specific part of an audio sink definition.
+ */
+class RoonSink
+{
+  public:
+    static constexpr auto INVALID_RANK = std::numeric_limits<uint16_t>::max();
+
+    const bool is_defined_;
+    const uint16_t rank_;
+    const std::string method_;
+
+    RoonSink(const RoonSink &) = delete;
+    RoonSink(RoonSink &&) = default;
+    RoonSink &operator=(const RoonSink &) = delete;
+    RoonSink &operator=(RoonSink &&) = default;
+
+    explicit RoonSink():
+        is_defined_(false),
+        rank_(INVALID_RANK)
+    {}
+
+    explicit RoonSink(uint16_t rank, std::string &&method):
+        is_defined_(true),
+        rank_(rank),
+        method_(std::move(method))
+    {}
+};
+
 class AudioSink: public Element
 {
   public:
+    const RoonSink roon_;
+
     AudioSink(const AudioSink &) = delete;
     AudioSink(AudioSink &&) = default;
     AudioSink &operator=(const AudioSink &) = delete;
     AudioSink &operator=(AudioSink &&) = default;
 
-    explicit AudioSink(const nlohmann::json &original_definition,
-                       std::string &&id, std::string &&description):
-        Element(original_definition, std::move(id), std::move(description))
+    explicit AudioSink(std::string &&id, std::string &&description,
+                       RoonSink &&roon):
+        Element(std::move(id), std::move(description)),
+        roon_(std::move(roon))
     {}
 
     virtual ~AudioSink() = default;
@@ -117,7 +146,7 @@ class Internal: public Element
   private:
     unsigned int number_of_inputs_;
     unsigned int number_of_outputs_;
-    std::unordered_map<std::string, std::unique_ptr<Control>> controls_;
+    std::unordered_map<std::string, std::shared_ptr<const Control>> controls_;
 
   public:
     Internal(const Internal &) = delete;
@@ -125,12 +154,11 @@ class Internal: public Element
     Internal &operator=(const Internal &) = delete;
     Internal &operator=(Internal &&) = default;
 
-    explicit Internal(const nlohmann::json &original_definition,
-                      std::string &&id, std::string &&description,
+    explicit Internal(std::string &&id, std::string &&description,
                       unsigned int number_of_inputs,
                       unsigned int number_of_outputs,
-                      std::unordered_map<std::string, std::unique_ptr<Control>> &&controls):
-        Element(original_definition, std::move(id), std::move(description)),
+                      std::unordered_map<std::string, std::shared_ptr<const Control>> &&controls):
+        Element(std::move(id), std::move(description)),
         number_of_inputs_(number_of_inputs),
         number_of_outputs_(number_of_outputs),
         controls_(std::move(controls))
@@ -33,25 +33,54 @@ namespace StaticModels
 namespace Elements
 {
 
+/*!
+ * Roon-specific part of a control definition.
+ *
+ * The conversion specification (template, value name, and value mapping) is
+ * interpreted by the Roon plugin only, so it is kept in JSON form here.
+ */
+class RoonControl
+{
+  public:
+    const bool is_defined_;
+    const unsigned int rank_;
+    const nlohmann::json conversion_;
+
+    RoonControl(const RoonControl &) = delete;
+    RoonControl(RoonControl &&) = default;
+    RoonControl &operator=(const RoonControl &) = delete;
+    RoonControl &operator=(RoonControl &&) = default;
+
+    explicit RoonControl():
+        is_defined_(false),
+        rank_(0)
+    {}
+
+    explicit RoonControl(unsigned int rank, nlohmann::json &&conversion):
+        is_defined_(true),
+        rank_(rank),
+        conversion_(std::move(conversion))
+    {}
+};
+
 /*!
  * Base class for all audio path element controls.
  */
 class Control
 {
   public:
-    const nlohmann::json &original_definition_;
     const std::string id_;
     const std::string label_;
     const std::string description_;
+    const RoonControl roon_;
 
   protected:
-    explicit Control(const nlohmann::json &original_definition,
-                    std::string &&id, std::string &&label,
-                    std::string &&description):
-        original_definition_(original_definition),
+    explicit Control(std::string &&id, std::string &&label,
+                     std::string &&description, RoonControl &&roon):
         id_(std::move(id)),
         label_(std::move(label)),
-        description_(std::move(description))
+        description_(std::move(description)),
+        roon_(std::move(roon))
     {
         if(id_.empty())
             Error() << "Empty control ID";
@@ -74,9 +103,38 @@ class Control
     virtual unsigned int to_selector_index(const ConfigStore::Value &value) const = 0;
     virtual const std::string &index_to_choice_string(unsigned int idx) const = 0;
 
-    const nlohmann::json &get_original_definition() const
+    /*!
+     * Turn value into the representation preferred by this control.
+     *
+     * This function is called once for each value stored for this control,
+     * so that later operations on the value are cheap. Values which are not
+     * acceptable for this control are left untouched.
+     */
+    virtual void resolve_value(ConfigStore::Value &) const {}
+
+    using ForEachScaledValueFn =
+        std::function<void(const std::string &scale, double value)>;
+
+    /*!
+     * Convert value to all scales defined for this control.
+     *
+     * Nothing happens for controls without scale mappings, and for values
+     * which cannot be mapped.
+     */
+    virtual void for_each_scaled_value(const ConfigStore::Value &,
+                                       const ForEachScaledValueFn &) const {}
+
+    /*!
+     * Convert value to given scale.
+     *
+     * \returns
+     *     True on success, false if the scale is not defined for this
+     *     control or if the value cannot be mapped.
+     */
+    virtual bool to_scale(const ConfigStore::Value &, const std::string &,
+                          double &) const
     {
-        return original_definition_;
+        return false;
     }
 };
 
@@ -85,7 +143,8 @@ class Control
  *
  * The values are always strings. These can be mapped to a zero-based range of
  * integers and vice versa, using the exact order as defined in the device
- * model.
+ * model. Values stored in the settings are resolved to that index when they
+ * are set (see #StaticModels::Elements::Choice::resolve_value()).
  */
 class Choice: public Control
 {
@@ -93,6 +152,7 @@ class Choice: public Control
     const std::vector<std::string> choices_;
     const std::string neutral_setting_;
     const std::unordered_map<std::string, unsigned int> choice_to_index_;
+    const unsigned int neutral_index_;
 
   public:
     Choice(const Choice &) = delete;
@@ -100,16 +160,20 @@ class Choice: public Control
     Choice &operator=(const Choice &) = delete;
     Choice &operator=(Choice &&) = default;
 
-    explicit Choice(const nlohmann::json &original_definition,
+    explicit Choice(RoonControl &&roon,
                     std::string &&id, std::string &&label,
                     std::string &&description,
                     std::vector<std::string> &&choices,
                     std::string &&neutral_setting):
-        Control(original_definition, std::move(id), std::move(label),
-                std::move(description)),
+        Control(std::move(id), std::move(label), std::move(description),
+                std::move(roon)),
         choices_(std::move(choices)),
         neutral_setting_(std::move(neutral_setting)),
-        choice_to_index_(std::move(Choice::hash_choices(choices_)))
+        choice_to_index_(std::move(Choice::hash_choices(choices_))),
+        neutral_index_(neutral_setting_.empty() ||
+                       choice_to_index_.find(neutral_setting_) == choice_to_index_.end()
+                       ? std::numeric_limits<unsigned int>::max()
+                       : choice_to_index_.at(neutral_setting_))
     {
         if(choices_.size() < 2)
             Error() << "Not enough choices for control \"" << id_ << "\"";
@@ -132,10 +196,13 @@ class Choice: public Control
 
     bool is_neutral_value(const ConfigStore::Value &value) const final override
     {
+        if(value.is_choice_of(choices_))
+            return value.get_choice_index() == neutral_index_;
+
         return
             !neutral_setting_.empty() &&
             value.is_of_type(ConfigStore::ValueType::VT_ASCIIZ) &&
-            value.get_value().get<std::string>() == neutral_setting_;
+            value.get_string() == neutral_setting_;
     }
 
     unsigned int get_number_of_choices() const final override
@@ -153,11 +220,24 @@ class Choice: public Control
     unsigned int to_selector_index(const ConfigStore::Value &value) const
         final override
     {
+        if(value.is_choice_of(choices_))
+            return value.get_choice_index();
+
         if(!value.is_of_type(ConfigStore::ValueType::VT_ASCIIZ))
             Error() << "Selector values for choices must be a string";
 
-        const auto &s(value.get_value().get<std::string>());
-        return choice_to_index_.at(s);
+        return choice_to_index_.at(std::string(value.get_string()));
+    }
+
+    void resolve_value(ConfigStore::Value &value) const final override
+    {
+        if(!value.is_of_type(ConfigStore::ValueType::VT_ASCIIZ) ||
+           value.is_choice_of(choices_))
+            return;
+
+        const auto it(choice_to_index_.find(std::string(value.get_string())));
+        if(it != choice_to_index_.end())
+            value = ConfigStore::Value::mk_choice(choices_, it->second);
     }
 
     const std::string &index_to_choice_string(unsigned int idx) const
@@ -179,10 +259,35 @@ class Choice: public Control
     }
 };
 
+/*!
+ * Mapping of a range control's values to some other scale.
+ *
+ * The table contains one entry per value in the range, in ascending order, so
+ * that conversion is a plain array access with the selector index.
+ */
+class ScaleTable
+{
+  public:
+    const std::string scale_;
+    const std::vector<double> table_;
+
+    ScaleTable(const ScaleTable &) = delete;
+    ScaleTable(ScaleTable &&) = default;
+    ScaleTable &operator=(const ScaleTable &) = delete;
+    ScaleTable &operator=(ScaleTable &&) = default;
+
+    explicit ScaleTable(std::string &&scale, std::vector<double> &&table):
+        scale_(std::move(scale)),
+        table_(std::move(table))
+    {}
+};
+
 /*!
  * Control which allows selecting any value between two boundaries.
  *
- * This control is the natural choice for numeric values.
+ * This control is the natural choice for numeric values. Integer ranges may
+ * be mapped to other scales (such as a step index to Hz) through tables
+ * defined in the model.
  */
 class Range: public Control
 {
@@ -192,6 +297,7 @@ class Range: public Control
     const ConfigStore::Value max_;
     const ConfigStore::Value step_;
     const ConfigStore::Value neutral_setting_;
+    const std::vector<ScaleTable> scale_tables_;
 
     struct SelectorSupport
     {
@@ -259,6 +365,20 @@ class Range: public Control
             return temp / step_;
         }
 
+        bool try_selector_index(int64_t value, unsigned int &idx) const
+        {
+            if(value < min_ || value > max_ || step_ == 0)
+                return false;
+
+            const uint64_t temp = value - min_;
+
+            if((temp % step_) != 0)
+                return false;
+
+            idx = temp / step_;
+            return true;
+        }
+
         void for_each_value(const ForEachChoiceFn &apply) const
         {
             unsigned int i = 0;
@@ -275,19 +395,21 @@ class Range: public Control
     Range &operator=(const Range &) = delete;
     Range &operator=(Range &&) = default;
 
-    explicit Range(const nlohmann::json &original_definition,
+    explicit Range(RoonControl &&roon,
                    std::string &&id, std::string &&label,
                    std::string &&description, std::string &&scale,
                    ConfigStore::Value &&min, ConfigStore::Value &&max,
                    ConfigStore::Value &&step,
-                   ConfigStore::Value &&neutral_setting):
-        Control(original_definition, std::move(id), std::move(label),
-                std::move(description)),
+                   ConfigStore::Value &&neutral_setting,
+                   std::vector<ScaleTable> &&scale_tables = {}):
+        Control(std::move(id), std::move(label), std::move(description),
+                std::move(roon)),
         scale_(std::move(scale)),
         min_(std::move(min)),
         max_(std::move(max)),
         step_(std::move(step)),
-        neutral_setting_(std::move(neutral_setting))
+        neutral_setting_(std::move(neutral_setting)),
+        scale_tables_(std::move(scale_tables))
     {
         if(!min_.is_numeric() ||
            !max_.equals_type_of(min_) || !step_.equals_type_of(min_))
@@ -318,6 +440,19 @@ class Range: public Control
                       step_.get_as(ConfigStore::ValueType::VT_UINT64)))
                 selector_support_.set_known();
         }
+
+        for(const auto &t : scale_tables_)
+        {
+            if(!selector_support_.is_known())
+                Error() << "Scale mappings require an integer range "
+                           "in control \"" << id_ << "\"";
+
+            if(t.table_.size() != selector_support_->number_of_choices_)
+                Error() << "Table for scale \"" << t.scale_
+                        << "\" has " << t.table_.size()
+                        << " entries, but control \"" << id_ << "\" has "
+                        << selector_support_->number_of_choices_ << " values";
+        }
     }
 
     ConfigStore::ValueType get_value_type() const final override
@@ -356,12 +491,12 @@ class Range: public Control
 
         if(value.is_integer())
             return selector_support_->to_selector_index(
-                                        value.get_value().get<int64_t>());
+                                        value.get_int64());
 
         if(value.is_of_type(ConfigStore::ValueType::VT_ASCIIZ))
         {
-            const auto &s(value.get_value().get<std::string>());
-            return selector_support_->to_selector_index(std::stoll(s));
+            return selector_support_->to_selector_index(
+                                        std::stoll(std::string(value.get_string())));
         }
 
         Error() << "Selector values for ranges must be integers or strings";
@@ -378,8 +513,42 @@ class Range: public Control
         return buffer;
     }
 
+    void for_each_scaled_value(const ConfigStore::Value &value,
+                               const ForEachScaledValueFn &apply) const
+        final override
+    {
+        unsigned int idx;
+
+        if(scale_tables_.empty() || !value_to_index(value, idx))
+            return;
+
+        for(const auto &t : scale_tables_)
+            apply(t.scale_, t.table_[idx]);
+    }
+
+    bool to_scale(const ConfigStore::Value &value, const std::string &scale,
+                  double &result) const final override
+    {
+        const auto t(std::find_if(scale_tables_.begin(), scale_tables_.end(),
+                                  [&scale] (const auto &st) { return st.scale_ == scale; }));
+        unsigned int idx;
+
+        if(t == scale_tables_.end() || !value_to_index(value, idx))
+            return false;
+
+        result = t->table_[idx];
+        return true;
+    }
+
     const ConfigStore::Value &get_min() const { return min_; }
     const ConfigStore::Value &get_max() const { return max_; }
+
+  private:
+    bool value_to_index(const ConfigStore::Value &value, unsigned int &idx) const
+    {
+        return value.is_integer() &&
+               selector_support_->try_selector_index(value.get_int64(), idx);
+    }
 };
 
 /*!
@@ -396,12 +565,12 @@ class OnOff: public Control
     OnOff &operator=(const OnOff &) = delete;
     OnOff &operator=(OnOff &&) = default;
 
-    explicit OnOff(const nlohmann::json &original_definition,
+    explicit OnOff(RoonControl &&roon,
                    std::string &&id, std::string &&label,
                    std::string &&description,
                    const std::string &neutral_setting):
-        Control(original_definition, std::move(id), std::move(label),
-                std::move(description)),
+        Control(std::move(id), std::move(label), std::move(description),
+                std::move(roon)),
         neutral_setting_(neutral_setting == "on")
     {
         if(neutral_setting != "on" && neutral_setting != "off")
@@ -418,7 +587,7 @@ class OnOff: public Control
     {
         return
             value.is_of_type(ConfigStore::ValueType::VT_BOOL) &&
-            value.get_value().get<bool>() == neutral_setting_;
+            value.get_bool() == neutral_setting_;
     }
 
     unsigned int get_number_of_choices() const final override
@@ -436,11 +605,11 @@ class OnOff: public Control
         final override
     {
         if(value.is_of_type(ConfigStore::ValueType::VT_BOOL))
-            return value.get_value().get<bool>() ? 1 : 0;
+            return value.get_bool() ? 1 : 0;
 
         if(value.is_of_type(ConfigStore::ValueType::VT_ASCIIZ))
         {
-            const auto &s(value.get_value().get<std::string>());
+            const auto s(value.get_string());
             if(s == "off")
                 return 0;
             else if(s == "on")
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "models_reload.hh"
+#include "configstore.hh"
+#include "configstore_json.hh"
+#include "configstore_changes.hh"
+#include "client_plugin_manager.hh"
+#include "messages.h"
+
+/*!
+ * Load device models file and build all models which have changed.
+ *
+ * \param device_models_file
+ *     The JSON file with all device models.
+ *
+ * \param compiled_models_file
+ *     Name of compiled models file, or \c nullptr if the models should be
+ *     loaded from JSON.
+ *
+ * \param hashes
+ *     Definition hashes of the models currently in use.
+ *
+ * \returns
+ *     The rebuilt models, or \c nullptr if the file could not be loaded. In
+ *     the latter case, the current models should be kept.
+ */
+std::unique_ptr<StaticModels::DeviceModelCache::Reload>
+ModelsReload::load_changed(const char *device_models_file,
+                           const char *compiled_models_file,
+                           const std::unordered_map<std::string, size_t> &hashes)
+{
+    auto reload(std::make_unique<StaticModels::DeviceModelCache::Reload>());
+    bool succeeded = false;
+
+    try
+    {
+        if(compiled_models_file != nullptr)
+            succeeded = reload->database_.load_compiled(device_models_file,
+                                                        compiled_models_file);
+        else if(reload->database_.load(device_models_file))
+        {
+            reload->database_.flatten();
+            succeeded = true;
+        }
+    }
+    catch(const std::exception &e)
+    {
+        msg_error(0, LOG_ERR, "%s", e.what());
+    }
+
+    if(!succeeded)
+    {
+        msg_error(0, LOG_ERR, "Keeping current device models");
+        return nullptr;
+    }
+
+    StaticModels::DeviceModelCache::rebuild_changed(*reload, hashes);
+    return reload;
+}
+
+/*!
+ * Swap reloaded models into the cache and switch the settings over to them.
+ *
+ * Changes still pending in the settings are reported before the old models
+ * are dropped because logged values may refer to these models.
+ *
+ * \returns
+ *     Number of models replaced in the cache.
+ */
+size_t ModelsReload::apply(StaticModels::DeviceModelCache &cache,
+                           ConfigStore::Settings &settings,
+                           const ClientPlugin::PluginManager &pm,
+                           StaticModels::DeviceModelCache::Reload &&reload)
+{
+    {
+        ConfigStore::Changes pending;
+        ConfigStore::SettingsJSON js(settings);
+
+        if(js.extract_changes(pending))
+            pm.report_changes(settings, pending);
+    }
+
+    const auto rebuilt(reload.size());
+    auto replaced(cache.swap_in(std::move(reload)));
+
+    if(settings.reattach_models())
+    {
+        ConfigStore::Changes changes;
+        pm.report_changes(settings, changes);
+    }
+
+    msg_info("Reloaded device models, %zu rebuilt, %zu replaced",
+             rebuilt, replaced.size());
+
+    return replaced.size();
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef MODELS_RELOAD_HH
+#define MODELS_RELOAD_HH
+
+#include "device_models.hh"
+
+#include <memory>
+
+namespace ConfigStore { class Settings; }
+namespace ClientPlugin { class PluginManager; }
+
+/*!
+ * Replacing device models while the settings are using them.
+ *
+ * A reload is done in two steps: changed models are loaded and built by
+ * #ModelsReload::load_changed(), which may run on any thread, and are then
+ * put to use by #ModelsReload::apply(), which must run on the thread which
+ * owns the settings.
+ */
+namespace ModelsReload
+{
+
+std::unique_ptr<StaticModels::DeviceModelCache::Reload>
+load_changed(const char *device_models_file, const char *compiled_models_file,
+             const std::unordered_map<std::string, size_t> &hashes);
+
+size_t apply(StaticModels::DeviceModelCache &cache,
+             ConfigStore::Settings &settings,
+             const ClientPlugin::PluginManager &pm,
+             StaticModels::DeviceModelCache::Reload &&reload);
+
+}
+
+#endif /* !MODELS_RELOAD_HH */
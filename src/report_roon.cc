@@ -33,6 +33,8 @@
 #include "model_parsing_utils_json.hh"
 #include "messages.h"
 
+#include <cmath>
+
 class Cache
 {
   public:
@@ -71,16 +73,14 @@ class Cache
 
     bool put_path(const ModelCompliant::CompoundSignalPathTracker &spt,
                   const ModelCompliant::CompoundSignalPath &path,
-                  const std::pair<uint16_t, std::string> *path_rank_and_method)
+                  const StaticModels::Elements::RoonSink *sink)
     {
-        if(path_rank_and_method == nullptr)
+        if(sink == nullptr)
             return false;
 
-        const auto &rm(*path_rank_and_method);
-
-        if(rm.first >= path_rank_)
+        if(sink->rank_ >= path_rank_)
         {
-            if(rm.first == path_rank_ && rm.first != INVALID_RANK)
+            if(sink->rank_ == path_rank_ && sink->rank_ != INVALID_RANK)
                 msg_error(0, LOG_WARNING,
                           "There are multiple equally ranked signal paths "
                           "(reporting only one of them to Roon)");
@@ -89,8 +89,8 @@ class Cache
         }
 
         path_ = spt.mk_self_contained_path(path);
-        path_rank_ = rm.first;
-        path_output_method_ = get_checked_output_method(rm.second);
+        path_rank_ = sink->rank_;
+        path_output_method_ = get_checked_output_method(sink->method_);
         reported_fragments_.clear();
         elem_to_frag_index_.clear();
         return true;
@@ -184,7 +184,8 @@ static AddResult process_flag_entry(const ConfigStore::Value &value,
                                     const StaticModels::Elements::OnOff &ctrl,
                                     const ProcessValueFn &process_fn)
 {
-    if(ctrl.get_neutral_value() == value.get_value())
+    if(value.is_of_type(ConfigStore::ValueType::VT_BOOL) &&
+       value.get_bool() == ctrl.get_neutral_value())
     {
         process_fn(nullptr, nullptr, ctrl);
         return AddResult::NEUTRAL;
@@ -196,12 +197,12 @@ static AddResult process_flag_entry(const ConfigStore::Value &value,
 
 template <ConfigStore::ValueType VT>
 static double compute_value_ratio(
-        const nlohmann::json &value,
+        const ConfigStore::Value &value,
         const ConfigStore::Value &range_min, const ConfigStore::Value &range_max)
 {
     const auto v(ConfigStore::get_range_checked<VT>(value));
-    const auto min(ConfigStore::get_range_checked<VT>(range_min.get_value()));
-    const auto max(ConfigStore::get_range_checked<VT>(range_max.get_value()));
+    const auto min(ConfigStore::get_range_checked<VT>(range_min));
+    const auto max(ConfigStore::get_range_checked<VT>(range_max));
 
     if(v >= min && v <= max && min <= max)
         return double(v - min) / (max - min);
@@ -209,6 +210,24 @@ static double compute_value_ratio(
         return std::numeric_limits<double>::infinity();
 }
 
+/*
+ * Fixed-point values are mapped in their native representation so that
+ * values on the range boundaries and the neutral value map exactly.
+ */
+static double compute_fix_point_ratio(
+        const ConfigStore::Value &value,
+        const ConfigStore::Value &range_min, const ConfigStore::Value &range_max)
+{
+    const auto v(value.get_fix_point_native());
+    const auto min(range_min.get_fix_point_native());
+    const auto max(range_max.get_fix_point_native());
+
+    if(v >= min && v <= max && min < max)
+        return double(v - min) / (max - min);
+    else
+        return std::numeric_limits<double>::infinity();
+}
+
 template <ConfigStore::ValueType VT, typename Traits = ConfigStore::ValueTypeTraits<VT>>
 static std::pair<nlohmann::json, AddResult>
 range_pick(double ratio,
@@ -229,6 +248,28 @@ range_pick(double ratio,
     return std::make_pair(nlohmann::json(value), AddResult::ADDED);
 }
 
+static std::pair<nlohmann::json, AddResult>
+range_pick_fix_point(double ratio,
+                     const std::pair<const nlohmann::json &, const nlohmann::json &> &range)
+{
+    if(ratio < 0.0 || ratio > 1.0)
+    {
+        MSG_BUG("Invalid ratio %f", ratio);
+        return std::make_pair(nlohmann::json(), AddResult::IGNORED);
+    }
+
+    const auto min(ConfigStore::Value(ConfigStore::ValueType::VT_TA_FIX_POINT,
+                                      range.first).get_fix_point_native());
+    const auto max(ConfigStore::Value(ConfigStore::ValueType::VT_TA_FIX_POINT,
+                                      range.second).get_fix_point_native());
+    const int64_t value = (min <= max)
+        ? min + std::llround(ratio * (max - min))
+        : max + std::llround((1.0 - ratio) * (min - max));
+
+    return std::make_pair(ConfigStore::Value::mk_fix_point(value).get_value(),
+                          AddResult::ADDED);
+}
+
 static auto get_mapping_target_type(const nlohmann::json &mapping)
 {
     const auto &target_type_code = mapping.at("value_type").get<std::string>();
@@ -257,52 +298,55 @@ map_value_to_range(const std::string &name, const ConfigStore::Value &value,
       case ConfigStore::ValueType::VT_VOID:
       case ConfigStore::ValueType::VT_ASCIIZ:
       case ConfigStore::ValueType::VT_BOOL:
+        break;
+
       case ConfigStore::ValueType::VT_TA_FIX_POINT:
+        ratio = compute_fix_point_ratio(value, ctrl->get_min(), ctrl->get_max());
         break;
 
       case ConfigStore::ValueType::VT_INT8:
         ratio = compute_value_ratio<ConfigStore::ValueType::VT_INT8>(
-                    value.get_value(), ctrl->get_min(), ctrl->get_max());
+                    value, ctrl->get_min(), ctrl->get_max());
         break;
 
       case ConfigStore::ValueType::VT_INT16:
         ratio = compute_value_ratio<ConfigStore::ValueType::VT_INT16>(
-                    value.get_value(), ctrl->get_min(), ctrl->get_max());
+                    value, ctrl->get_min(), ctrl->get_max());
         break;
 
       case ConfigStore::ValueType::VT_INT32:
         ratio = compute_value_ratio<ConfigStore::ValueType::VT_INT32>(
-                    value.get_value(), ctrl->get_min(), ctrl->get_max());
+                    value, ctrl->get_min(), ctrl->get_max());
         break;
 
       case ConfigStore::ValueType::VT_INT64:
         ratio = compute_value_ratio<ConfigStore::ValueType::VT_INT64>(
-                    value.get_value(), ctrl->get_min(), ctrl->get_max());
+                    value, ctrl->get_min(), ctrl->get_max());
         break;
 
       case ConfigStore::ValueType::VT_UINT8:
         ratio = compute_value_ratio<ConfigStore::ValueType::VT_UINT8>(
-                    value.get_value(), ctrl->get_min(), ctrl->get_max());
+                    value, ctrl->get_min(), ctrl->get_max());
         break;
 
       case ConfigStore::ValueType::VT_UINT16:
         ratio = compute_value_ratio<ConfigStore::ValueType::VT_UINT16>(
-                    value.get_value(), ctrl->get_min(), ctrl->get_max());
+                    value, ctrl->get_min(), ctrl->get_max());
         break;
 
       case ConfigStore::ValueType::VT_UINT32:
         ratio = compute_value_ratio<ConfigStore::ValueType::VT_UINT32>(
-                    value.get_value(), ctrl->get_min(), ctrl->get_max());
+                    value, ctrl->get_min(), ctrl->get_max());
         break;
 
       case ConfigStore::ValueType::VT_UINT64:
         ratio = compute_value_ratio<ConfigStore::ValueType::VT_UINT64>(
-                    value.get_value(), ctrl->get_min(), ctrl->get_max());
+                    value, ctrl->get_min(), ctrl->get_max());
         break;
 
       case ConfigStore::ValueType::VT_DOUBLE:
         ratio = compute_value_ratio<ConfigStore::ValueType::VT_DOUBLE>(
-                    value.get_value(), ctrl->get_min(), ctrl->get_max());
+                    value, ctrl->get_min(), ctrl->get_max());
         break;
     }
 
@@ -323,9 +367,11 @@ map_value_to_range(const std::string &name, const ConfigStore::Value &value,
       case ConfigStore::ValueType::VT_VOID:
       case ConfigStore::ValueType::VT_ASCIIZ:
       case ConfigStore::ValueType::VT_BOOL:
-      case ConfigStore::ValueType::VT_TA_FIX_POINT:
         break;
 
+      case ConfigStore::ValueType::VT_TA_FIX_POINT:
+        return range_pick_fix_point(ratio, output_range);
+
       case ConfigStore::ValueType::VT_INT8:
         return range_pick<ConfigStore::ValueType::VT_INT8>(ratio, output_range);
 
@@ -384,7 +430,7 @@ map_value_as_balance_slider(const std::string &name,
 
       case ConfigStore::ValueType::VT_ASCIIZ:
         {
-            const int64_t input = value.get_value().get<int64_t>();
+            const int64_t input = value.get_int64();
 
             if(input < 0)
                 return std::make_pair(nlohmann::json("L" + std::to_string(-input)),
@@ -724,11 +770,10 @@ static void add_empty_ranked_entry(const StaticModels::Elements::Internal &elem,
                                    const StaticModels::Elements::Control &ctrl,
                                    RankedControls &ranked_controls)
 {
-    const auto it(ctrl.original_definition_.find("roon"));
-    if(it == ctrl.original_definition_.end())
+    if(!ctrl.roon_.is_defined_)
         return;
 
-    const auto rank = StaticModels::Utils::get<unsigned int>(*it, "rank", 0);
+    const auto rank = ctrl.roon_.rank_;
 
     if(ranked_controls.find(rank) == ranked_controls.end())
         ranked_controls.emplace(rank, std::make_pair(nlohmann::json(), &ctrl));
@@ -747,19 +792,20 @@ static bool patch_entry_for_name(const ConfigStore::DeviceContext &dev,
                                  const StaticModels::Elements::Control &ctrl,
                                  nlohmann::json &entry)
 {
-    const auto it(ctrl.original_definition_.find("roon"));
-    if(it == ctrl.original_definition_.end())
+    if(!ctrl.roon_.is_defined_)
         return false;
 
+    const auto &conversion(ctrl.roon_.conversion_);
+
     try
     {
-        switch(process_entry(dev, name, value, ctrl, *it,
-                [&it, &entry]
+        switch(process_entry(dev, name, value, ctrl, conversion,
+                [&conversion, &entry]
                 (nlohmann::json &&v, const std::string *key, const auto &c)
                 {
                     if(v != nullptr)
                     {
-                        nlohmann::json t = it->at("template");
+                        nlohmann::json t = conversion.at("template");
 
                         if(key != nullptr)
                             t[*key] = std::move(v);
@@ -788,42 +834,14 @@ static bool patch_entry_for_name(const ConfigStore::DeviceContext &dev,
     return false;
 }
 
-static const std::pair<uint16_t, std::string> *
-determine_path_rank_and_output_method(
-        const ModelCompliant::CompoundSignalPathTracker &spt,
-        const ModelCompliant::CompoundSignalPath &p,
-        std::unordered_map<const StaticModels::Elements::AudioSink *,
-                           std::pair<uint16_t, std::string>> &ranks)
+static const StaticModels::Elements::RoonSink *
+determine_roon_sink(const ModelCompliant::CompoundSignalPathTracker &spt,
+                    const ModelCompliant::CompoundSignalPath &p)
 {
     const auto &dev(spt.settings_iterator_.with_device(spt.map_path_index_to_device_name(p.back().first)));
     const auto *sink = dev.get_model()->get_audio_sink(p.back().second->get_name());
-    const auto &r(ranks.find(sink));
-    if(r != ranks.end())
-        return &r->second;
-
-    if(sink == nullptr)
-    {
-        ranks.emplace(sink, std::make_pair(Cache::INVALID_RANK, ""));
-        return nullptr;
-    }
-
-    const auto it(sink->original_definition_.find("roon"));
-    if(it == sink->original_definition_.end())
-    {
-        ranks.emplace(sink, std::make_pair(Cache::INVALID_RANK, ""));
-        return nullptr;
-    }
-
-    auto rank(StaticModels::Utils::get<uint16_t>(*it, "rank",
-                                                 uint16_t(Cache::INVALID_RANK)));
-    auto output_method(StaticModels::Utils::get<std::string>(*it, "method", ""));
-
-    if(output_method.empty())
-        MSG_BUG("Roon output method undefined for sink %s in model for %s",
-                sink->id_.c_str(), dev.get_model()->name_.c_str());
 
-    return &ranks.emplace(sink, std::make_pair(rank, std::move(output_method)))
-                .first->second;
+    return sink != nullptr && sink->roon_.is_defined_ ? &sink->roon_ : nullptr;
 }
 
 static RankedControls
@@ -905,21 +923,18 @@ static nlohmann::json generate_report_from_cache(const Cache &cache)
 static nlohmann::json
 compute_sorted_result(const ConfigStore::SettingsIterator &settings_iter,
                       const std::string &root_device_instance_name,
-                      Cache &cache,
-                      std::unordered_map<const StaticModels::Elements::AudioSink *,
-                                         std::pair<uint16_t, std::string>> &ranks)
+                      Cache &cache)
 {
     ModelCompliant::CompoundSignalPathTracker spt(settings_iter);
 
     /* find active path with highest rank */
     spt.enumerate_compound_signal_paths(
         root_device_instance_name,
-        [&spt, &cache, &ranks]
+        [&spt, &cache]
         (const auto &active_path)
         {
             cache.put_path(spt, active_path,
-                           determine_path_rank_and_output_method(spt, active_path,
-                                                                 ranks));
+                           determine_roon_sink(spt, active_path));
             return true;
         });
 
@@ -968,7 +983,7 @@ bool ClientPlugin::Roon::full_report(const ConfigStore::Settings &settings,
 
     try
     {
-        output = compute_sorted_result(si, "self", cache, ranks_);
+        output = compute_sorted_result(si, "self", cache);
     }
     catch(const std::out_of_range &e)
     {
@@ -41,7 +41,6 @@ namespace StaticModels
     namespace Elements
     {
         class Control;
-        class AudioSink;
     }
 }
 
@@ -57,8 +56,6 @@ class Roon: public Plugin
   private:
     const EmitSignalPathFn emit_audio_signal_path_fn_;
     mutable nlohmann::json previous_roon_report_;
-    mutable std::unordered_map<const StaticModels::Elements::AudioSink *,
-                               std::pair<uint16_t, std::string>> ranks_;
 
   public:
     Roon(const Roon &) = delete;
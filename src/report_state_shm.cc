@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "report_state_shm.hh"
+#include "configstore.hh"
+#include "configstore_json.hh"
+#include "configstore_iter.hh"
+#include "messages.h"
+
+void ClientPlugin::StateSHMPublisher::registered()
+{
+    msg_info("Registered plugin \"%s\"", name_.c_str());
+}
+
+void ClientPlugin::StateSHMPublisher::unregistered()
+{
+    msg_info("Unregistered plugin \"%s\"", name_.c_str());
+}
+
+/*!
+ * Collect active paths and the signal types arriving at their sinks.
+ */
+static nlohmann::json
+collect_active_paths(const ConfigStore::Settings &settings,
+                     const nlohmann::json &devices, nlohmann::json &signal_types)
+{
+    const ConfigStore::SettingsIterator si(settings);
+    nlohmann::json result = nlohmann::json::object();
+    signal_types = nlohmann::json::object();
+
+    for(const auto &dev : devices.items())
+    {
+        auto &paths(result[dev.key()] = nlohmann::json::array());
+        auto &types(signal_types[dev.key()] = nlohmann::json::object());
+        const auto dev_ctx(si.with_device(dev.key()));
+
+        dev_ctx.for_each_signal_path(
+            [&paths, &types, &dev_ctx] (const auto &p)
+            {
+                nlohmann::json path = nlohmann::json::array();
+
+                for(const auto &elem : p)
+                    path.push_back(elem.first->get_name());
+
+                paths.push_back(std::move(path));
+
+                auto t(dev_ctx.get_signal_types(p));
+                if(!t.empty())
+                    types[p.back().first->get_name()] = std::move(t);
+
+                return true;
+            });
+    }
+
+    return result;
+}
+
+void ClientPlugin::StateSHMPublisher::report_changes(
+        const ConfigStore::Settings &settings,
+        const ConfigStore::Changes &changes) const
+{
+    publish(settings);
+}
+
+bool ClientPlugin::StateSHMPublisher::full_report(
+        const ConfigStore::Settings &settings,
+        std::string &report, std::vector<std::string> &extra) const
+{
+    auto state(ConfigStore::ConstSettingsJSON(settings).json());
+    const auto devices(state.find("devices"));
+
+    nlohmann::json output;
+    nlohmann::json signal_types = nlohmann::json::object();
+    output["active_paths"] = devices != state.end()
+        ? collect_active_paths(settings, *devices, signal_types)
+        : nlohmann::json::object();
+    output["signal_types"] = std::move(signal_types);
+    output["settings"] = std::move(state);
+    output["stale"] = settings.is_stale();
+
+    report = output.dump();
+    return true;
+}
+
+/*!
+ * Write current state to shared memory, but only if it has changed.
+ */
+void ClientPlugin::StateSHMPublisher::publish(const ConfigStore::Settings &settings) const
+{
+    std::string state;
+    std::vector<std::string> dummy;
+
+    full_report(settings, state, dummy);
+
+    if(state == previous_state_)
+        return;
+
+    if(writer_->publish(state))
+        previous_state_ = std::move(state);
+    else
+        previous_state_.clear();
+}
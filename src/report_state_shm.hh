@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef REPORT_STATE_SHM_HH
+#define REPORT_STATE_SHM_HH
+
+#include "client_plugin.hh"
+#include "state_shm_writer.hh"
+
+#include <memory>
+
+namespace ClientPlugin
+{
+
+/*!
+ * Publish settings and active signal paths to shared memory.
+ *
+ * The shared memory region is updated once per batch of changes reported to
+ * this plugin, and only if the published state has actually changed.
+ */
+class StateSHMPublisher: public Plugin
+{
+  private:
+    std::unique_ptr<StateSHM::Writer> writer_;
+    mutable std::string previous_state_;
+
+  public:
+    StateSHMPublisher(const StateSHMPublisher &) = delete;
+    StateSHMPublisher(StateSHMPublisher &&) = default;
+    StateSHMPublisher &operator=(const StateSHMPublisher &) = delete;
+    StateSHMPublisher &operator=(StateSHMPublisher &&) = default;
+
+    explicit StateSHMPublisher(std::unique_ptr<StateSHM::Writer> writer):
+        Plugin("StateSHM"),
+        writer_(std::move(writer))
+    {}
+
+    void registered() final override;
+    void unregistered() final override;
+    void report_changes(const ConfigStore::Settings &settings,
+                        const ConfigStore::Changes &changes) const final override;
+    bool full_report(const ConfigStore::Settings &settings,
+                     std::string &report, std::vector<std::string> &extra) const
+        final override;
+
+    void publish(const ConfigStore::Settings &settings) const;
+};
+
+}
+
+#endif /* !REPORT_STATE_SHM_HH */
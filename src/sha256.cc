@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "sha256.hh"
+
+static inline uint32_t rotr(uint32_t x, unsigned int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+/*!
+ * SHA-256 digest of \p data as specified in FIPS 180-4.
+ */
+Hashing::SHA256Digest Hashing::sha256(const std::string &data)
+{
+    static constexpr std::array<uint32_t, 64> k
+    {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+        0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+        0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+        0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+        0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+        0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+        0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+        0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+        0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+    };
+
+    std::array<uint32_t, 8> h
+    {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+
+    /* message padded to a multiple of 64 bytes, length in bits at the end */
+    std::string msg(data);
+    const uint64_t length_in_bits = uint64_t(msg.size()) * 8;
+    msg.push_back(char(0x80));
+    while(msg.size() % 64 != 56)
+        msg.push_back('\0');
+    for(int i = 7; i >= 0; --i)
+        msg.push_back(char(length_in_bits >> (i * 8)));
+
+    std::array<uint32_t, 64> w;
+
+    for(size_t chunk = 0; chunk < msg.size(); chunk += 64)
+    {
+        for(size_t i = 0; i < 16; ++i)
+            w[i] = (uint32_t(uint8_t(msg[chunk + 4 * i + 0])) << 24) |
+                   (uint32_t(uint8_t(msg[chunk + 4 * i + 1])) << 16) |
+                   (uint32_t(uint8_t(msg[chunk + 4 * i + 2])) << 8) |
+                   (uint32_t(uint8_t(msg[chunk + 4 * i + 3])));
+
+        for(size_t i = 16; i < 64; ++i)
+        {
+            const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        auto v(h);
+
+        for(size_t i = 0; i < 64; ++i)
+        {
+            const uint32_t s1 = rotr(v[4], 6) ^ rotr(v[4], 11) ^ rotr(v[4], 25);
+            const uint32_t ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+            const uint32_t t1 = v[7] + s1 + ch + k[i] + w[i];
+            const uint32_t s0 = rotr(v[0], 2) ^ rotr(v[0], 13) ^ rotr(v[0], 22);
+            const uint32_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+            const uint32_t t2 = s0 + maj;
+
+            v[7] = v[6];
+            v[6] = v[5];
+            v[5] = v[4];
+            v[4] = v[3] + t1;
+            v[3] = v[2];
+            v[2] = v[1];
+            v[1] = v[0];
+            v[0] = t1 + t2;
+        }
+
+        for(size_t i = 0; i < 8; ++i)
+            h[i] += v[i];
+    }
+
+    SHA256Digest result;
+
+    for(size_t i = 0; i < 8; ++i)
+        for(size_t j = 0; j < 4; ++j)
+            result[4 * i + j] = uint8_t(h[i] >> (24 - 8 * j));
+
+    return result;
+}
@@ -27,17 +27,54 @@
 
 bool ModelCompliant::SignalPathTracker::select(
         const std::string &element_name,
-        const StaticModels::SignalPaths::Selector &sel)
+        const StaticModels::SignalPaths::Selector &sel,
+        bool &active_paths_changed)
 {
     const auto *const elem = dev_.lookup_switching_element(element_name);
 
     if(elem == nullptr)
     {
+        active_paths_changed = false;
         MSG_APPLIANCE_BUG("Cannot select nonexistent switching element %s in %s",
                           element_name.c_str(), dev_.get_name().c_str());
         return false;
     }
 
+    return select(elem->get_selector_handle(), sel, active_paths_changed);
+}
+
+bool ModelCompliant::SignalPathTracker::floating(const std::string &element_name,
+                                                 bool &active_paths_changed)
+{
+    const auto *const elem = dev_.lookup_switching_element(element_name);
+
+    if(elem == nullptr)
+    {
+        active_paths_changed = false;
+        MSG_APPLIANCE_BUG("Cannot float nonexistent switching element %s in %s",
+                          dev_.get_name().c_str(), element_name.c_str());
+        return false;
+    }
+
+    return floating(elem->get_selector_handle(), active_paths_changed);
+}
+
+bool ModelCompliant::SignalPathTracker::select(
+        const StaticModels::SignalPaths::SelectorHandle &handle,
+        const StaticModels::SignalPaths::Selector &sel,
+        bool &active_paths_changed)
+{
+    active_paths_changed = false;
+
+    const auto *const elem = dev_.lookup_switching_element(handle);
+
+    if(elem == nullptr)
+    {
+        MSG_BUG("Cannot select switching element with invalid handle %u in %s",
+                handle.get(), dev_.get_name().c_str());
+        return false;
+    }
+
     if(!elem->is_selector_in_range(sel))
     {
         MSG_BUG("Selector value %u out of range for %s.%s",
@@ -46,70 +83,330 @@ bool ModelCompliant::SignalPathTracker::select(
         return false;
     }
 
-    auto it(selector_values_.find(elem));
+    auto &value(selector_values_[handle.get()]);
+
+    if(value == sel)
+        return false;
+
+    const auto old_sel(value);
+    value = sel;
+
+    active_paths_changed = update_activity(*elem, old_sel);
+    selector_state_changed(active_paths_changed);
+    return true;
+}
+
+bool ModelCompliant::SignalPathTracker::floating(
+        const StaticModels::SignalPaths::SelectorHandle &handle,
+        bool &active_paths_changed)
+{
+    active_paths_changed = false;
 
-    if(it == selector_values_.end())
+    const auto *const elem = dev_.lookup_switching_element(handle);
+
+    if(elem == nullptr)
     {
-        selector_values_.insert({elem, sel});
-        return true;
+        MSG_BUG("Cannot float switching element with invalid handle %u in %s",
+                handle.get(), dev_.get_name().c_str());
+        return false;
     }
 
-    if(it->second != sel)
+    auto &value(selector_values_[handle.get()]);
+
+    if(!value.is_valid())
+        return false;
+
+    const auto old_sel(value);
+    value = StaticModels::SignalPaths::Selector::mk_invalid();
+
+    active_paths_changed = update_activity(*elem, old_sel);
+    selector_state_changed(active_paths_changed);
+    return true;
+}
+
+/*!
+ * Whether or not given element lies on any active signal path.
+ *
+ * This is a constant time lookup, no traversal is involved.
+ */
+bool ModelCompliant::SignalPathTracker::is_on_active_path(
+        const StaticModels::SignalPaths::PathElement &elem) const
+{
+    const auto idx = elem.get_index();
+    const auto &a(activity_[idx]);
+
+    if(elem.is_source())
+        return dev_.get_graph().is_sink(idx)
+            ? a.live_outputs_ != 0
+            : (a.live_outputs_ & a.draining_outputs_) != 0;
+
+    return (a.fed_inputs_ & a.draining_inputs_) != 0;
+}
+
+static inline unsigned int lowest_pad(uint64_t mask)
+{
+    return __builtin_ctzll(mask);
+}
+
+void ModelCompliant::SignalPathTracker::init_activity()
+{
+    const auto &g(dev_.get_graph());
+    activity_.assign(g.size(), Activity{0, 0, 0, 0});
+    pending_.reserve(g.size());
+
+    /* paths cannot be longer than the number of elements */
+    traversal_stack_.reserve(g.size() + 1);
+    upstream_stack_.reserve(g.size() + 1);
+    traversal_path_.reserve(g.size() + 1);
+    traversal_types_.reserve(g.size() + 1);
+    sink_signal_types_.resize(g.size(), 0);
+
+    for(uint32_t idx = 0; idx < g.size(); ++idx)
+        pending_.push_back(idx);
+
+    propagate_downstream();
+
+    for(uint32_t idx = 0; idx < g.size(); ++idx)
+        pending_.push_back(idx);
+
+    propagate_upstream();
+}
+
+/*!
+ * Outputs of given element reached by an active path from a source.
+ *
+ * This mirrors the rules applied by the depth-first traversal: only the
+ * first output of a source is followed, static elements pass their input
+ * signals to all outputs, and switching elements pass them according to
+ * their selector (invalid selectors connect nothing).
+ */
+ModelCompliant::SignalPathTracker::PadMask
+ModelCompliant::SignalPathTracker::compute_live_outputs(uint32_t idx) const
+{
+    const auto &elem(dev_.get_graph().get_element(idx));
+    const auto &a(activity_[idx]);
+    const auto *sw = elem.as_switching_element();
+
+    if(sw != nullptr)
     {
-        it->second = sel;
-        return true;
+        const auto sel(get_selector_value(sw));
+        PadMask result = 0;
+
+        for(PadMask in = a.fed_inputs_; in != 0; in &= in - 1)
+            result |= sw->get_matrix().outputs_fed_by(
+                            sel, StaticModels::SignalPaths::Input(lowest_pad(in)));
+
+        return result;
     }
 
-    return false;
+    if(elem.is_source())
+        return elem.is_sub_element() ? 0 : 1;
+
+    return a.fed_inputs_ != 0 ? ~PadMask(0) : 0;
 }
 
-bool ModelCompliant::SignalPathTracker::floating(const std::string &element_name)
+/*!
+ * Inputs of given element from which an active path leads to a sink.
+ */
+ModelCompliant::SignalPathTracker::PadMask
+ModelCompliant::SignalPathTracker::compute_draining_inputs(uint32_t idx) const
 {
-    const auto *const elem = dev_.lookup_switching_element(element_name);
+    const auto &g(dev_.get_graph());
+    const auto &elem(g.get_element(idx));
+    const auto &a(activity_[idx]);
+    const auto *sw = elem.as_switching_element();
 
-    if(elem == nullptr)
+    if(sw != nullptr)
     {
-        MSG_APPLIANCE_BUG("Cannot float nonexistent switching element %s in %s",
-                          dev_.get_name().c_str(), element_name.c_str());
-        return false;
+        const auto sel(get_selector_value(sw));
+        PadMask result = 0;
+
+        for(PadMask out = a.draining_outputs_; out != 0; out &= out - 1)
+            result |= sw->get_matrix().inputs_feeding(
+                            sel, StaticModels::SignalPaths::Output(lowest_pad(out)));
+
+        return result;
     }
 
-    return selector_values_.erase(elem) > 0;
+    if(g.is_sink(idx))
+        return ~PadMask(0);
+
+    return a.draining_outputs_ != 0 ? ~PadMask(0) : 0;
 }
 
-class DepthFirst
+/*!
+ * Update live outputs of pending elements and everything downstream of them.
+ */
+void ModelCompliant::SignalPathTracker::propagate_downstream()
 {
-  public:
-    enum class TraverseAction
+    const auto &g(dev_.get_graph());
+
+    while(!pending_.empty())
+    {
+        const auto idx = pending_.back();
+        pending_.pop_back();
+
+        const auto live = compute_live_outputs(idx);
+
+        if(live == activity_[idx].live_outputs_)
+            continue;
+
+        activity_[idx].live_outputs_ = live;
+
+        for(const auto *o = g.outputs_begin(idx); o != g.outputs_end(idx); ++o)
+        {
+            for(const auto *e = g.edges_begin(*o); e != g.edges_end(*o); ++e)
+            {
+                PadMask fed = 0;
+
+                for(const auto *in = g.incoming_begin(e->target_);
+                    in != g.incoming_end(e->target_); ++in)
+                    if((activity_[in->source_].live_outputs_ & (PadMask(1) << in->source_pad_)) != 0)
+                        fed |= PadMask(1) << in->target_pad_;
+
+                if(fed != activity_[e->target_].fed_inputs_)
+                {
+                    activity_[e->target_].fed_inputs_ = fed;
+                    pending_.push_back(e->target_);
+                }
+            }
+        }
+    }
+}
+
+/*!
+ * Update draining inputs of pending elements and everything upstream of them.
+ */
+void ModelCompliant::SignalPathTracker::propagate_upstream()
+{
+    const auto &g(dev_.get_graph());
+
+    while(!pending_.empty())
     {
-        CONTINUE,
-        SKIP,
-        ABORT,
-    };
-
-    using TraverseCallbackFn =
-        std::function<TraverseAction(
-                        const StaticModels::SignalPaths::PathElement *parent,
-                        const StaticModels::SignalPaths::PathElement &elem,
-                        const StaticModels::SignalPaths::Input &elem_input_index,
-                        const StaticModels::SignalPaths::Output &elem_output_index,
-                        unsigned int depth)>;
+        const auto idx = pending_.back();
+        pending_.pop_back();
+
+        const auto draining = compute_draining_inputs(idx);
+
+        if(draining == activity_[idx].draining_inputs_)
+            continue;
+
+        activity_[idx].draining_inputs_ = draining;
 
+        for(const auto *in = g.incoming_begin(idx); in != g.incoming_end(idx); ++in)
+        {
+            PadMask out_mask = 0;
+
+            for(const auto *o = g.outputs_begin(in->source_);
+                o != g.outputs_end(in->source_); ++o)
+                for(const auto *e = g.edges_begin(*o); e != g.edges_end(*o); ++e)
+                    if((activity_[e->target_].draining_inputs_ & (PadMask(1) << e->target_pad_)) != 0)
+                    {
+                        out_mask |= PadMask(1) << o->pad_;
+                        break;
+                    }
+
+            if(out_mask != activity_[in->source_].draining_outputs_)
+            {
+                activity_[in->source_].draining_outputs_ = out_mask;
+                pending_.push_back(in->source_);
+            }
+        }
+    }
+}
+
+/*!
+ * Update element activity after the selector of a switching element has
+ * changed.
+ *
+ * Only the elements downstream and upstream of the switching element are
+ * touched.
+ *
+ * \returns
+ *     True if the set of active signal paths has changed, false if not. The
+ *     latter is the case if the connections changed by the selector are not
+ *     fed by any source, or do not lead to any sink.
+ */
+bool ModelCompliant::SignalPathTracker::update_activity(
+        const StaticModels::SignalPaths::SwitchingElement &elem,
+        const StaticModels::SignalPaths::Selector &old_sel)
+{
+    const auto idx = elem.get_index();
+    const auto &a(activity_[idx]);
+    const auto &m(elem.get_matrix());
+    const auto new_sel(get_selector_value(&elem));
+    bool result = false;
+
+    for(PadMask in = a.fed_inputs_; in != 0; in &= in - 1)
+    {
+        const StaticModels::SignalPaths::Input input(lowest_pad(in));
+
+        if(((m.outputs_fed_by(old_sel, input) ^ m.outputs_fed_by(new_sel, input)) &
+            a.draining_outputs_) != 0)
+        {
+            result = true;
+            break;
+        }
+    }
+
+    pending_.push_back(idx);
+    propagate_downstream();
+    pending_.push_back(idx);
+    propagate_upstream();
+
+    return result;
+}
+
+namespace ModelCompliant
+{
+
+enum class TraverseAction
+{
+    CONTINUE,
+    SKIP,
+    ABORT,
+};
+
+/*!
+ * Depth-first traversal of the signal path graph, starting at the sources.
+ *
+ * The visitor is called for each source, and for each element reached
+ * through an edge once per output of that element (or once with an
+ * unconnected output if the element is a sink). It is passed in as template
+ * parameter so that it can be inlined.
+ *
+ * The traversal is iterative and runs on an explicit stack owned by the
+ * tracker, sized for the graph in advance. Thus, traversing makes no
+ * allocations.
+ */
+template <typename VisitorFn>
+class DepthFirst
+{
   private:
-    const ModelCompliant::SignalPathTracker &tracker_;
-    const TraverseCallbackFn &apply_;
-    unsigned int depth_;
+    using Frame = SignalPathTracker::TraversalFrame;
+
+    const StaticModels::SignalPaths::CompactGraph &graph_;
+    std::vector<Frame> &stack_;
+    VisitorFn apply_;
 
   public:
     DepthFirst(const DepthFirst &) = delete;
-
-    explicit DepthFirst(const ModelCompliant::SignalPathTracker &tracker,
-                        unsigned int depth, const TraverseCallbackFn &apply):
-        tracker_(tracker),
-        apply_(apply),
-        depth_(depth)
+    DepthFirst(DepthFirst &&) = default;
+    DepthFirst &operator=(const DepthFirst &) = delete;
+    DepthFirst &operator=(DepthFirst &&) = delete;
+
+    explicit DepthFirst(const SignalPathTracker &tracker, VisitorFn &&apply):
+        graph_(tracker.get_appliance().get_graph()),
+        stack_(tracker.traversal_stack_),
+        apply_(std::move(apply))
     {}
 
+    /*!
+     * Traverse the graph.
+     *
+     * \returns
+     *     False if the traversal has been aborted, true otherwise.
+     */
     bool traverse(const std::vector<std::pair<const StaticModels::SignalPaths::PathElement *, bool>> &sources)
     {
         for(const auto &source : sources)
@@ -118,14 +415,21 @@ class DepthFirst
             if(source.first->is_sub_element())
                 continue;
 
-            switch(apply_(nullptr, *source.first,
+            switch(apply_(static_cast<const StaticModels::SignalPaths::PathElement *>(nullptr),
+                          *source.first,
                           StaticModels::SignalPaths::Input::mk_unconnected(),
-                          StaticModels::SignalPaths::Output(0),
-                          depth_))
+                          StaticModels::SignalPaths::Output(0), 0))
             {
               case TraverseAction::CONTINUE:
-                if(!down(*source.first, StaticModels::SignalPaths::Output(0)))
-                    return false;
+                {
+                    const auto *output =
+                        graph_.find_output(source.first->get_index(),
+                                           StaticModels::SignalPaths::Output(0));
+
+                    if(output != nullptr &&
+                       !down_from(source.first->get_index(), *output))
+                        return false;
+                }
 
                 break;
 
@@ -140,137 +444,222 @@ class DepthFirst
         return true;
     }
 
-    bool down(const StaticModels::SignalPaths::PathElement &elem,
-              const StaticModels::SignalPaths::Output &elem_target_index)
+  private:
+    void push(uint32_t elem_index,
+              const StaticModels::SignalPaths::CompactGraph::OutputPad &output)
     {
-        using IterAction = StaticModels::SignalPaths::PathElement::IterAction;
+        stack_.push_back({elem_index, graph_.edges_begin(output),
+                          graph_.edges_end(output), nullptr});
+    }
 
-        ++depth_;
+    /*!
+     * Follow all edges leaving given output of given source, recursively.
+     *
+     * Each stack frame corresponds to an output of an element on the current
+     * path. It holds the edge of that output currently followed, and the
+     * next output of the edge's target to be visited. A frame is popped when
+     * all its edges have been followed, or when a sink at one of its edges
+     * requests skipping the remaining edges.
+     *
+     * \returns
+     *     False if the traversal has been aborted, true otherwise.
+     */
+    bool down_from(uint32_t elem_index,
+                   const StaticModels::SignalPaths::CompactGraph::OutputPad &output)
+    {
+        stack_.clear();
+        push(elem_index, output);
+
+        while(!stack_.empty())
+        {
+            auto &frame(stack_.back());
+            const unsigned int depth = stack_.size();
 
-        const auto process_edges_result =
-            elem.for_each_outgoing_edge(elem_target_index,
-            [this, &elem, &elem_target_index]
-            (const auto &outedge)
+            if(frame.edge_ == frame.edges_end_)
             {
-                const auto &target(outedge.get_target_element());
-                const auto target_input_index = outedge.get_target_input_pad();
+                stack_.pop_back();
+                continue;
+            }
+
+            const auto &elem(graph_.get_element(frame.element_));
+            const auto target_index = frame.edge_->target_;
+            const auto &target(graph_.get_element(target_index));
+            const StaticModels::SignalPaths::Input target_input_index(frame.edge_->target_pad_);
 
-                if(target.is_sink())
+            if(frame.next_output_ == nullptr)
+            {
+                if(graph_.is_sink(target_index))
                 {
                     /* found a sink */
                     switch(apply_(&elem, target, target_input_index,
                                   StaticModels::SignalPaths::Output::mk_unconnected(),
-                                  depth_))
+                                  depth))
                     {
                       case TraverseAction::CONTINUE:
-                        return IterAction::CONTINUE;
+                        ++frame.edge_;
+                        continue;
 
                       case TraverseAction::SKIP:
-                        return IterAction::DONE;
+                        stack_.pop_back();
+                        continue;
 
                       case TraverseAction::ABORT:
-                        break;
+                        return false;
                     }
-
-                    return IterAction::ABORT;
                 }
 
-                const auto result = target.for_each_output(
-                    [this, &elem, &target, &target_input_index]
-                    (const auto target_output_index)
-                    {
-                        switch(apply_(&elem, target, target_input_index,
-                                      target_output_index, depth_))
-                        {
-                          case TraverseAction::CONTINUE:
-                            if(!down(target, target_output_index))
-                                return IterAction::ABORT;
-
-                            break;
-
-                          case TraverseAction::SKIP:
-                            break;
-
-                          case TraverseAction::ABORT:
-                            return IterAction::ABORT;
-                        }
-
-                        return IterAction::CONTINUE;
-                    });
+                frame.next_output_ = graph_.outputs_begin(target_index);
+            }
 
-                return result == IterAction::DONE ? IterAction::CONTINUE : result;
-            });
+            if(frame.next_output_ == graph_.outputs_end(target_index))
+            {
+                ++frame.edge_;
+                frame.next_output_ = nullptr;
+                continue;
+            }
 
-        --depth_;
+            const auto &target_output(*frame.next_output_++);
 
-        switch(process_edges_result)
-        {
-          case IterAction::EMPTY:
-          case IterAction::DONE:
-            return true;
+            switch(apply_(&elem, target, target_input_index,
+                          StaticModels::SignalPaths::Output(target_output.pad_),
+                          depth))
+            {
+              case TraverseAction::CONTINUE:
+                push(target_index, target_output);
+                break;
 
-          case IterAction::ABORT:
-            break;
+              case TraverseAction::SKIP:
+                break;
 
-          case IterAction::CONTINUE:
-            MSG_BUG("Unexpected edge processing result");
-            break;
+              case TraverseAction::ABORT:
+                return false;
+            }
         }
 
-        return false;
+        return true;
     }
 };
 
-static DepthFirst::TraverseAction
-collect(const StaticModels::SignalPaths::PathElement *parent,
-        const StaticModels::SignalPaths::PathElement &elem,
+}
+
+static ModelCompliant::TraverseAction
+collect(const StaticModels::SignalPaths::PathElement &elem,
         const StaticModels::SignalPaths::Input &elem_input_index,
         const StaticModels::SignalPaths::Output &elem_output_index,
         unsigned int depth,
         const ModelCompliant::SignalPathTracker &tracker,
         ModelCompliant::SignalPathTracker::ActivePath &path)
 {
-    const auto *sw =
-        dynamic_cast<const StaticModels::SignalPaths::SwitchingElement *>(&elem);
+    const auto *sw = elem.as_switching_element();
 
     if(sw != nullptr)
     {
         const StaticModels::SignalPaths::Selector sel = tracker.get_selector_value(sw);
 
         if(!sel.is_valid())
-            return DepthFirst::TraverseAction::SKIP;
+            return ModelCompliant::TraverseAction::SKIP;
 
         if(!sw->is_connected(sel, elem_input_index, elem_output_index))
-            return DepthFirst::TraverseAction::SKIP;
+            return ModelCompliant::TraverseAction::SKIP;
     }
 
     if(depth <= path.size())
         path.resize(depth);
 
     path.emplace_back(&elem, false);
-    return DepthFirst::TraverseAction::CONTINUE;
+    return ModelCompliant::TraverseAction::CONTINUE;
 }
 
-bool ModelCompliant::SignalPathTracker::enumerate_active_signal_paths(
-        const EnumerateCallbackFn &fn) const
+size_t ModelCompliant::SignalPathTracker::SelectorStateHash::operator()(
+        const SelectorState &state) const
+{
+    size_t result = state.size();
+
+    for(const auto &v : state)
+        result ^= v + 0x9e3779b9 + (result << 6) + (result >> 2);
+
+    return result;
+}
+
+ModelCompliant::SignalPathTracker::SelectorState
+ModelCompliant::SignalPathTracker::get_selector_state() const
 {
-    ActivePath path;
+    SelectorState result;
+    result.reserve(selector_values_.size());
 
-    return DepthFirst(*this, 0,
-        [this, &fn, &path]
-        (const auto *parent, const auto &elem,
+    for(const auto &sel : selector_values_)
+        result.push_back(sel.get());
+
+    return result;
+}
+
+/*!
+ * Cached active signal paths for the current selector values.
+ *
+ * Active paths are cached for a bounded number of selector states, so that
+ * switching back and forth between a few configurations does not require any
+ * traversals. The cache lives as long as the tracker, which is replaced
+ * whenever the appliance model changes.
+ */
+ModelCompliant::SignalPathTracker::CachedPaths &
+ModelCompliant::SignalPathTracker::get_current_paths() const
+{
+    if(current_paths_ != nullptr)
+        return *current_paths_;
+
+    auto state(get_selector_state());
+    const auto found(active_paths_cache_.find(state));
+
+    if(found != active_paths_cache_.end())
+    {
+        current_paths_ = &found->second;
+        return *current_paths_;
+    }
+
+    if(active_paths_cache_.size() >= MAX_CACHED_SELECTOR_STATES)
+    {
+        active_paths_cache_.erase(active_paths_cache_order_.front());
+        active_paths_cache_order_.pop_front();
+    }
+
+    active_paths_cache_order_.push_back(state);
+    current_paths_ = &active_paths_cache_.emplace(std::move(state), CachedPaths()).first->second;
+    return *current_paths_;
+}
+
+/*!
+ * All active signal paths for the current selector values.
+ *
+ * The paths are computed by a traversal of the signal path graph, starting
+ * at the sources.
+ */
+const std::vector<ModelCompliant::SignalPathTracker::ActivePath> &
+ModelCompliant::SignalPathTracker::lookup_active_paths() const
+{
+    auto &cached(get_current_paths());
+
+    if(cached.is_complete_)
+        return cached.all_;
+
+    auto &paths(cached.all_);
+    auto &path(traversal_path_);
+    paths.clear();
+    path.clear();
+
+    DepthFirst(*this,
+        [this, &paths, &path]
+        (const auto *, const auto &elem,
          const auto &elem_input_index, const auto &elem_output_index,
          unsigned int depth)
         {
             const auto collect_result =
-                collect(parent, elem, elem_input_index, elem_output_index,
+                collect(elem, elem_input_index, elem_output_index,
                         depth, *this, path);
 
-            if(collect_result == DepthFirst::TraverseAction::CONTINUE &&
+            if(collect_result == TraverseAction::CONTINUE &&
                elem.is_sink())
             {
-                if(!fn(path))
-                    return DepthFirst::TraverseAction::ABORT;
+                paths.push_back(path);
 
                 for(auto &p : path)
                     p.second = true;
@@ -278,4 +667,201 @@ bool ModelCompliant::SignalPathTracker::enumerate_active_signal_paths(
 
             return collect_result;
         }).traverse(sources_);
+
+    cached.is_complete_ = true;
+    return paths;
+}
+
+/*!
+ * Active signal paths ending in given sink for the current selector values.
+ *
+ * The paths are computed by walking upstream from the sink along incoming
+ * edges. Only inputs known to be fed by a source, and outputs known to carry
+ * a signal from a source are followed (see
+ * #ModelCompliant::SignalPathTracker::Activity), so that the walk never runs
+ * into dead ends. The cost is proportional to the size of the resulting
+ * paths, not to the size of the graph.
+ */
+const std::vector<ModelCompliant::SignalPathTracker::ActivePath> &
+ModelCompliant::SignalPathTracker::lookup_active_paths_to_sink(uint32_t sink_index) const
+{
+    auto &cached(get_current_paths());
+    const auto found(cached.by_sink_.find(sink_index));
+
+    if(found != cached.by_sink_.end())
+        return found->second;
+
+    auto &paths(cached.by_sink_[sink_index]);
+    const auto &g(dev_.get_graph());
+    const auto &sink(g.get_element(sink_index));
+
+    if(!g.is_sink(sink_index))
+        return paths;
+
+    if(sink.is_source())
+    {
+        if(activity_[sink_index].live_outputs_ != 0)
+            paths.push_back({{&sink, false}});
+
+        return paths;
+    }
+
+    if(sink.get_kind() != StaticModels::SignalPaths::PathElement::Kind::STATIC)
+        return paths;
+
+    /* path from the sink up to the element on top of the stack */
+    auto &tail(traversal_path_);
+    tail.clear();
+    tail.emplace_back(&sink, false);
+
+    auto &stack(upstream_stack_);
+    stack.clear();
+    stack.push_back({sink_index, activity_[sink_index].fed_inputs_,
+                     g.incoming_begin(sink_index), g.incoming_end(sink_index)});
+
+    while(!stack.empty())
+    {
+        auto &frame(stack.back());
+
+        if(frame.edge_ == frame.edges_end_)
+        {
+            stack.pop_back();
+            tail.pop_back();
+            continue;
+        }
+
+        const auto &edge(*frame.edge_++);
+
+        if((frame.inputs_ & (PadMask(1) << edge.target_pad_)) == 0 ||
+           (activity_[edge.source_].live_outputs_ & (PadMask(1) << edge.source_pad_)) == 0)
+            continue;
+
+        const auto &elem(g.get_element(edge.source_));
+
+        if(elem.is_source())
+        {
+            ActivePath path;
+            path.reserve(tail.size() + 1);
+            path.emplace_back(&elem, false);
+            path.insert(path.end(), tail.rbegin(), tail.rend());
+            paths.push_back(std::move(path));
+
+            for(auto &t : tail)
+                t.second = true;
+
+            continue;
+        }
+
+        const auto *sw = elem.as_switching_element();
+        const auto inputs =
+            sw != nullptr
+            ? activity_[edge.source_].fed_inputs_ &
+              sw->get_matrix().inputs_feeding(
+                    get_selector_value(sw),
+                    StaticModels::SignalPaths::Output(edge.source_pad_))
+            : activity_[edge.source_].fed_inputs_;
+
+        tail.emplace_back(&elem, false);
+        stack.push_back({edge.source_, inputs,
+                         g.incoming_begin(edge.source_), g.incoming_end(edge.source_)});
+    }
+
+    return paths;
+}
+
+bool ModelCompliant::SignalPathTracker::enumerate_active_signal_paths(
+        const EnumerateCallbackFn &fn) const
+{
+    for(const auto &path : lookup_active_paths())
+        if(!fn(path))
+            return false;
+
+    return true;
+}
+
+/*!
+ * Enumerate active signal paths ending in given sink.
+ *
+ * The paths are passed to \p fn in the same form as by
+ * #ModelCompliant::SignalPathTracker::enumerate_active_signal_paths(), from
+ * source to sink. Elements on the path towards the sink which have been
+ * passed in the previous path already are marked. Nothing is enumerated if
+ * \p sink is not a sink.
+ *
+ * \returns
+ *     False if \p fn has aborted the enumeration, true otherwise.
+ */
+bool ModelCompliant::SignalPathTracker::enumerate_active_signal_paths_to_sink(
+        const StaticModels::SignalPaths::PathElement &sink,
+        const EnumerateCallbackFn &fn) const
+{
+    if(sink.get_index() >= dev_.get_graph().size() ||
+       &dev_.get_graph().get_element(sink.get_index()) != &sink)
+        return true;
+
+    for(const auto &path : lookup_active_paths_to_sink(sink.get_index()))
+        if(!fn(path))
+            return false;
+
+    return true;
+}
+
+/*!
+ * Signal types arriving at given sink with the current selector values.
+ *
+ * The types are computed for all sinks at once in a single traversal of the
+ * active signal paths, and are cached until a selector changes.
+ *
+ * \returns
+ *     The union of the types arriving through all active paths ending in
+ *     \p sink, or 0 if there is no active path or no types are declared.
+ */
+StaticModels::SignalPaths::SignalTypes
+ModelCompliant::SignalPathTracker::get_signal_types(
+        const StaticModels::SignalPaths::PathElement &sink) const
+{
+    if(!is_sink_signal_types_valid_)
+        compute_sink_signal_types();
+
+    const auto idx = sink.get_index();
+    return idx < sink_signal_types_.size() ? sink_signal_types_[idx] : 0;
+}
+
+void ModelCompliant::SignalPathTracker::compute_sink_signal_types() const
+{
+    std::fill(sink_signal_types_.begin(), sink_signal_types_.end(), 0);
+
+    auto &path(traversal_path_);
+    auto &types(traversal_types_);
+    path.clear();
+    types.clear();
+
+    DepthFirst(*this,
+        [this, &path, &types]
+        (const auto *, const auto &elem,
+         const auto &elem_input_index, const auto &elem_output_index,
+         unsigned int depth)
+        {
+            const auto collect_result =
+                collect(elem, elem_input_index, elem_output_index,
+                        depth, *this, path);
+
+            if(collect_result != TraverseAction::CONTINUE)
+                return collect_result;
+
+            const auto at_input =
+                elem.get_input_types(depth > 0 ? types[depth - 1] : 0);
+
+            if(elem.is_sink())
+                sink_signal_types_[elem.get_index()] |= at_input;
+            else
+            {
+                types.resize(depth);
+                types.push_back(elem.get_output_types(elem_output_index, at_input));
+            }
+
+            return collect_result;
+        }).traverse(sources_);
+
+    is_sink_signal_types_valid_ = true;
 }
@@ -24,9 +24,13 @@
 
 #include "signal_paths.hh"
 
+#include <deque>
+
 namespace ModelCompliant
 {
 
+template <typename VisitorFn> class DepthFirst;
+
 /*!
  * Per-instance audio signal path tracking.
  */
@@ -34,10 +38,41 @@ class SignalPathTracker
 {
   private:
     const StaticModels::SignalPaths::Appliance &dev_;
-    std::unordered_map<const StaticModels::SignalPaths::SwitchingElement *,
-                       StaticModels::SignalPaths::Selector> selector_values_;
+
+    /* selector value of each switching element, indexed by selector handle */
+    std::vector<StaticModels::SignalPaths::Selector> selector_values_;
+
     std::vector<std::pair<const StaticModels::SignalPaths::PathElement *, bool>> sources_;
 
+    using PadMask = StaticModels::SignalPaths::MappingMatrix::Word;
+
+    /*!
+     * Which pads of an element take part in active signal paths.
+     *
+     * Inputs and outputs are considered "fed" or "live" if there is an active
+     * path from a source up to them, and "draining" if there is an active
+     * path from them down to a sink. An element lies on an active path if
+     * these two meet.
+     */
+    struct Activity
+    {
+        PadMask fed_inputs_;
+        PadMask live_outputs_;
+        PadMask draining_inputs_;
+        PadMask draining_outputs_;
+    };
+
+    /* activity of each element, indexed by graph index */
+    std::vector<Activity> activity_;
+
+    /* work list for updating #ModelCompliant::SignalPathTracker::activity_ */
+    std::vector<uint32_t> pending_;
+
+    /* signal types arriving at each sink with the current selector values,
+     * indexed by graph index */
+    mutable std::vector<StaticModels::SignalPaths::SignalTypes> sink_signal_types_;
+    mutable bool is_sink_signal_types_valid_;
+
   public:
     SignalPathTracker(const SignalPathTracker &) = delete;
     SignalPathTracker(SignalPathTracker &&) = default;
@@ -45,24 +80,65 @@ class SignalPathTracker
     SignalPathTracker &operator=(SignalPathTracker &&) = default;
 
     explicit SignalPathTracker(const StaticModels::SignalPaths::Appliance &dev):
-        dev_(dev)
+        dev_(dev),
+        selector_values_(dev.get_number_of_switching_elements(),
+                         StaticModels::SignalPaths::Selector::mk_invalid()),
+        is_sink_signal_types_valid_(false),
+        current_paths_(nullptr)
     {
         dev_.for_each_source(
             [this] (const auto &src) { sources_.push_back({&src, false}); });
+        init_activity();
     }
 
     bool select(const std::string &element_name,
-                const StaticModels::SignalPaths::Selector &sel);
+                const StaticModels::SignalPaths::Selector &sel)
+    {
+        bool dummy;
+        return select(element_name, sel, dummy);
+    }
 
-    bool floating(const std::string &element_name);
+    bool select(const std::string &element_name,
+                const StaticModels::SignalPaths::Selector &sel,
+                bool &active_paths_changed);
+
+    bool floating(const std::string &element_name)
+    {
+        bool dummy;
+        return floating(element_name, dummy);
+    }
+
+    bool floating(const std::string &element_name, bool &active_paths_changed);
+
+    bool select(const StaticModels::SignalPaths::SelectorHandle &handle,
+                const StaticModels::SignalPaths::Selector &sel)
+    {
+        bool dummy;
+        return select(handle, sel, dummy);
+    }
+
+    bool select(const StaticModels::SignalPaths::SelectorHandle &handle,
+                const StaticModels::SignalPaths::Selector &sel,
+                bool &active_paths_changed);
+
+    bool floating(const StaticModels::SignalPaths::SelectorHandle &handle)
+    {
+        bool dummy;
+        return floating(handle, dummy);
+    }
+
+    bool floating(const StaticModels::SignalPaths::SelectorHandle &handle,
+                  bool &active_paths_changed);
+
+    bool is_on_active_path(const StaticModels::SignalPaths::PathElement &elem) const;
 
     StaticModels::SignalPaths::Selector
     get_selector_value(const StaticModels::SignalPaths::SwitchingElement *elem) const
     {
-        const auto it(selector_values_.find(elem));
+        const auto idx = elem->get_selector_handle().get();
 
-        if(it != selector_values_.end())
-            return it->second;
+        if(idx < selector_values_.size())
+            return selector_values_[idx];
         else
             return StaticModels::SignalPaths::Selector::mk_invalid();
     }
@@ -71,6 +147,105 @@ class SignalPathTracker
         std::vector<std::pair<const StaticModels::SignalPaths::PathElement *, bool>>;
     using EnumerateCallbackFn = std::function<bool(const ActivePath &)>;
     bool enumerate_active_signal_paths(const EnumerateCallbackFn &fn) const;
+    bool enumerate_active_signal_paths_to_sink(
+            const StaticModels::SignalPaths::PathElement &sink,
+            const EnumerateCallbackFn &fn) const;
+
+    StaticModels::SignalPaths::SignalTypes
+    get_signal_types(const StaticModels::SignalPaths::PathElement &sink) const;
+
+    /*!
+     * Signal types transported along an active path, as seen by its sink.
+     */
+    StaticModels::SignalPaths::SignalTypes
+    get_signal_types(const ActivePath &path) const
+    {
+        return path.empty() ? 0 : get_signal_types(*path.back().first);
+    }
+
+    const StaticModels::SignalPaths::Appliance &get_appliance() const { return dev_; }
+
+  private:
+    template <typename VisitorFn> friend class DepthFirst;
+
+    /* one level of an iterative depth-first traversal */
+    struct TraversalFrame
+    {
+        uint32_t element_;
+        const StaticModels::SignalPaths::CompactGraph::Edge *edge_;
+        const StaticModels::SignalPaths::CompactGraph::Edge *edges_end_;
+        const StaticModels::SignalPaths::CompactGraph::OutputPad *next_output_;
+    };
+
+    /* one level of an iterative upstream traversal */
+    struct UpstreamFrame
+    {
+        uint32_t element_;
+        PadMask inputs_;
+        const StaticModels::SignalPaths::CompactGraph::IncomingEdge *edge_;
+        const StaticModels::SignalPaths::CompactGraph::IncomingEdge *edges_end_;
+    };
+
+    /* buffers reused by all traversals, sized for the graph */
+    mutable std::vector<TraversalFrame> traversal_stack_;
+    mutable std::vector<UpstreamFrame> upstream_stack_;
+    mutable ActivePath traversal_path_;
+    mutable std::vector<StaticModels::SignalPaths::SignalTypes> traversal_types_;
+
+    /*
+     * Selector values indexed by selector handle, with floating elements
+     * represented by invalid selector values.
+     */
+    using SelectorState = std::vector<uint32_t>;
+
+    struct SelectorStateHash
+    {
+        size_t operator()(const SelectorState &state) const;
+    };
+
+    /* maximum number of selector states the active paths are kept for */
+    static constexpr size_t MAX_CACHED_SELECTOR_STATES = 16;
+
+    /* active paths for one selector state, filled in on demand */
+    struct CachedPaths
+    {
+        bool is_complete_;
+        std::vector<ActivePath> all_;
+        std::unordered_map<uint32_t, std::vector<ActivePath>> by_sink_;
+
+        explicit CachedPaths(): is_complete_(false) {}
+    };
+
+    /* active paths for the most recently seen selector states */
+    mutable std::unordered_map<SelectorState, CachedPaths,
+                               SelectorStateHash> active_paths_cache_;
+    mutable std::deque<SelectorState> active_paths_cache_order_;
+
+    /* active paths for the current selector values, or \c nullptr */
+    mutable CachedPaths *current_paths_;
+
+    void selector_state_changed(bool active_paths_changed)
+    {
+        if(!active_paths_changed)
+            return;
+
+        is_sink_signal_types_valid_ = false;
+        current_paths_ = nullptr;
+    }
+
+    void init_activity();
+    PadMask compute_live_outputs(uint32_t idx) const;
+    PadMask compute_draining_inputs(uint32_t idx) const;
+    void propagate_downstream();
+    void propagate_upstream();
+    bool update_activity(const StaticModels::SignalPaths::SwitchingElement &elem,
+                         const StaticModels::SignalPaths::Selector &old_sel);
+
+    SelectorState get_selector_state() const;
+    CachedPaths &get_current_paths() const;
+    const std::vector<ActivePath> &lookup_active_paths() const;
+    const std::vector<ActivePath> &lookup_active_paths_to_sink(uint32_t sink_index) const;
+    void compute_sink_signal_types() const;
 };
 
 }
@@ -35,6 +35,7 @@
 #include <algorithm>
 #include <memory>
 #include <limits>
+#include <cstdint>
 
 namespace StaticModels
 {
@@ -106,7 +107,39 @@ class Selector: public IndexBase
     bool operator>=(const Selector &other) const { return value_ >= other.value_; }
 };
 
+/*!
+ * Dense number of a switching element within its appliance.
+ *
+ * Handles are resolved from element names once, so that selectors can be set
+ * without any lookups by name. See
+ * #StaticModels::SignalPaths::Appliance::lookup_selector_handle().
+ */
+class SelectorHandle: public IndexBase
+{
+  public:
+    explicit SelectorHandle(unsigned int value): IndexBase(value) {}
+    virtual ~SelectorHandle() = default;
+
+    static SelectorHandle mk_invalid() { return SelectorHandle(INVALID); }
+
+    bool operator==(const SelectorHandle &other) const { return value_ == other.value_; }
+    bool operator!=(const SelectorHandle &other) const { return value_ != other.value_; }
+};
+
+/*!
+ * Set of signal types (such as PCM or DSD), one bit per type.
+ *
+ * The bits are assigned by the #StaticModels::SignalPaths::ApplianceBuilder
+ * while building the appliance, so sets from different appliances cannot be
+ * compared directly. Use #StaticModels::SignalPaths::Appliance::to_names()
+ * for this.
+ */
+using SignalTypes = uint32_t;
+
 class PathElement;
+class SwitchingElement;
+class CompactGraph;
+class Appliance;
 
 /*!
  * Representation of a signal path connection from an element to another
@@ -154,9 +187,26 @@ class PathElement
         CONTINUE,
     };
 
+    /*!
+     * Concrete type of a path element, so that no RTTI is needed.
+     */
+    enum class Kind
+    {
+        STATIC,
+        SWITCHING,
+    };
+
   private:
+    friend CompactGraph;
+    friend class MappingMatrix;
+
     static constexpr auto UNREASONABLE = 50;
 
+    Kind kind_;
+
+    /* dense index assigned by #StaticModels::SignalPaths::CompactGraph */
+    uint32_t index_;
+
   protected:
     std::string name_;
     std::set<const PathElement *> sources_;
@@ -165,9 +215,17 @@ class PathElement
              std::unordered_map<std::string, const OutgoingEdge *>> edges_by_output_;
     const PathElement *parent_element_;
 
-    explicit PathElement(std::string &&name):
+    SignalTypes input_types_;
+    SignalTypes output_types_;
+    std::map<Output, SignalTypes> output_types_by_pad_;
+
+    explicit PathElement(Kind kind, std::string &&name):
+        kind_(kind),
+        index_(std::numeric_limits<uint32_t>::max()),
         name_(std::move(name)),
-        parent_element_(nullptr)
+        parent_element_(nullptr),
+        input_types_(0),
+        output_types_(0)
     {}
 
   public:
@@ -178,6 +236,10 @@ class PathElement
     virtual ~PathElement() = default;
 
     const std::string get_name() const { return name_; }
+    uint32_t get_index() const { return index_; }
+    Kind get_kind() const { return kind_; }
+
+    inline const SwitchingElement *as_switching_element() const;
 
     IterAction for_each_output(
             const std::function<IterAction(const Output)> &apply) const
@@ -264,13 +326,58 @@ class PathElement
 
     bool is_sub_element() const { return parent_element_ != nullptr; }
 
-    virtual void finalize(const std::string &device_id) const
+    void declare_input_types(SignalTypes types) { input_types_ |= types; }
+    void declare_output_types(SignalTypes types) { output_types_ |= types; }
+
+    void declare_output_types(const Output &output, SignalTypes types)
+    {
+        output_types_by_pad_[output] |= types;
+    }
+
+    /*!
+     * Signal types accepted by this element, given the types fed into it.
+     *
+     * Elements without declared input types accept anything. Otherwise, the
+     * types are narrowed down to the declared types; if there is no common
+     * type at all, then a conversion must have happened somewhere upstream
+     * and the declared types are returned.
+     */
+    SignalTypes get_input_types(SignalTypes incoming) const
+    {
+        return narrow_types(incoming, input_types_);
+    }
+
+    /*!
+     * Signal types emitted at given output, given the types at the input.
+     *
+     * Same rules as for #StaticModels::SignalPaths::PathElement::get_input_types(),
+     * where types declared for a specific output take precedence over types
+     * declared for the whole element.
+     */
+    SignalTypes get_output_types(const Output &output, SignalTypes at_input) const
+    {
+        const auto it(output_types_by_pad_.find(output));
+        return narrow_types(at_input,
+                            it != output_types_by_pad_.end() ? it->second : output_types_);
+    }
+
+    virtual void finalize(const std::string &device_id)
     {
         if(sources_.empty() && all_outgoing_edges_.empty() && parent_element_ == nullptr)
             msg_error(0, LOG_NOTICE,
                       "Element %s.%s is unconnected",
                       device_id.c_str(), name_.c_str());
     }
+
+  private:
+    static SignalTypes narrow_types(SignalTypes incoming, SignalTypes declared)
+    {
+        if(declared == 0)
+            return incoming;
+
+        const auto common = incoming & declared;
+        return common != 0 ? common : declared;
+    }
 };
 
 /*!
@@ -286,7 +393,7 @@ class StaticElement: public PathElement
     StaticElement &operator=(StaticElement &&) = default;
 
     explicit StaticElement(std::string &&name):
-        PathElement(std::move(name))
+        PathElement(Kind::STATIC, std::move(name))
     {}
 
     virtual ~StaticElement() = default;
@@ -334,6 +441,14 @@ class Mapping
 
     virtual bool is_connected(const Selector &sel,
                               const Input &in, const Output &out) const = 0;
+
+    using ConnectionFn =
+        std::function<void(const Selector &sel, const Input &in, const Output &out)>;
+
+    /*!
+     * Enumerate all input/output connections for all selector values.
+     */
+    virtual void for_each_connection(const ConnectionFn &apply) const = 0;
 };
 
 template <typename T>
@@ -401,11 +516,18 @@ class MappingMux: public Mapping
                       const Input &in, const Output &out) const
         final override
     {
-        if(out != Output(0) || !in.is_valid())
+        if(out != Output(0) || !in.is_valid() ||
+           sel.get() >= input_by_selector_.size())
             return false;
 
-        const auto from = input_by_selector_.at(sel.get());
-        return from == in;
+        return input_by_selector_[sel.get()] == in;
+    }
+
+    void for_each_connection(const ConnectionFn &apply) const final override
+    {
+        for(Selector sel(0); sel.get() < input_by_selector_.size(); ++sel)
+            if(input_by_selector_[sel.get()].is_valid())
+                apply(sel, input_by_selector_[sel.get()], Output(0));
     }
 };
 
@@ -451,11 +573,18 @@ class MappingDemux: public Mapping
                       const Input &in, const Output &out) const
         final override
     {
-        if(in != Input(0) || !out.is_valid())
+        if(in != Input(0) || !out.is_valid() ||
+           sel.get() >= output_by_selector_.size())
             return false;
 
-        const auto to = output_by_selector_.at(sel.get());
-        return out == to;
+        return output_by_selector_[sel.get()] == out;
+    }
+
+    void for_each_connection(const ConnectionFn &apply) const final override
+    {
+        for(Selector sel(0); sel.get() < output_by_selector_.size(); ++sel)
+            if(output_by_selector_[sel.get()].is_valid())
+                apply(sel, Input(0), output_by_selector_[sel.get()]);
     }
 };
 
@@ -517,18 +646,126 @@ class MappingTable: public Mapping
                       const Input &in, const Output &out) const
         final override
     {
-        if(!in.is_valid() || !out.is_valid())
+        if(!in.is_valid() || !out.is_valid() || sel.get() >= tables_.size())
             return false;
 
-        try
-        {
-            const auto &table(tables_.at(sel.get()));
-            return table.find({in, out}) != table.end();
-        }
-        catch(const std::out_of_range &e)
-        {
-            return false;
-        }
+        const auto &table(tables_[sel.get()]);
+        return table.find({in, out}) != table.end();
+    }
+
+    void for_each_connection(const ConnectionFn &apply) const final override
+    {
+        for(Selector sel(0); sel.get() < tables_.size(); ++sel)
+            for(const auto &edge : tables_[sel.get()])
+                apply(sel, edge.first, edge.second);
+    }
+};
+
+/*!
+ * Dense representation of a #StaticModels::SignalPaths::Mapping.
+ *
+ * For each selector value, there is an NxM bit matrix with N inputs and M
+ * outputs. Each row (the outputs fed by an input) and each column (the inputs
+ * feeding an output) is stored in a single machine word. Elements cannot be
+ * connected through pads beyond
+ * #StaticModels::SignalPaths::PathElement::UNREASONABLE, so a word is
+ * enough for all pads which may carry a signal.
+ */
+class MappingMatrix
+{
+  public:
+    using Word = uint64_t;
+    static constexpr unsigned int MAX_PADS = sizeof(Word) * 8;
+
+    static_assert(PathElement::UNREASONABLE <= MAX_PADS,
+                  "connectable pads must fit into a matrix word");
+
+  private:
+    unsigned int number_of_inputs_;
+    unsigned int number_of_outputs_;
+    unsigned int number_of_choices_;
+
+    /* row of input n for selector c at index c * number_of_inputs_ + n */
+    std::vector<Word> rows_;
+
+    /* column of output m for selector c at index c * number_of_outputs_ + m */
+    std::vector<Word> columns_;
+
+  public:
+    MappingMatrix(const MappingMatrix &) = delete;
+    MappingMatrix(MappingMatrix &&) = default;
+    MappingMatrix &operator=(const MappingMatrix &) = delete;
+    MappingMatrix &operator=(MappingMatrix &&) = default;
+
+    explicit MappingMatrix():
+        number_of_inputs_(0),
+        number_of_outputs_(0),
+        number_of_choices_(0)
+    {}
+
+    /*!
+     * Build matrices from mapping.
+     *
+     * Connections involving pads which cannot be connected are ignored.
+     */
+    explicit MappingMatrix(const Mapping &mapping):
+        number_of_inputs_(0),
+        number_of_outputs_(0),
+        number_of_choices_(mapping.number_of_choices())
+    {
+        mapping.for_each_connection(
+            [this] (const Selector &sel, const Input &in, const Output &out)
+            {
+                if(in.get() < MAX_PADS && out.get() < MAX_PADS)
+                {
+                    number_of_inputs_ = std::max(number_of_inputs_, in.get() + 1);
+                    number_of_outputs_ = std::max(number_of_outputs_, out.get() + 1);
+                }
+                else
+                    MSG_BUG("Mapping pad index too large for matrix "
+                            "(%u -> %u for selector value %u) [connection ignored]",
+                            in.get(), out.get(), sel.get());
+            });
+
+        rows_.resize(number_of_choices_ * number_of_inputs_, 0);
+        columns_.resize(number_of_choices_ * number_of_outputs_, 0);
+
+        mapping.for_each_connection(
+            [this] (const Selector &sel, const Input &in, const Output &out)
+            {
+                if(in.get() < MAX_PADS && out.get() < MAX_PADS)
+                {
+                    rows_[sel.get() * number_of_inputs_ + in.get()] |=
+                        Word(1) << out.get();
+                    columns_[sel.get() * number_of_outputs_ + out.get()] |=
+                        Word(1) << in.get();
+                }
+            });
+    }
+
+    bool is_connected(const Selector &sel, const Input &in, const Output &out) const
+    {
+        return out.get() < MAX_PADS && (outputs_fed_by(sel, in) & (Word(1) << out.get())) != 0;
+    }
+
+    /*!
+     * Bit mask of outputs fed by input \p in with selector set to \p sel.
+     */
+    Word outputs_fed_by(const Selector &sel, const Input &in) const
+    {
+        return sel.get() < number_of_choices_ && in.get() < number_of_inputs_
+            ? rows_[sel.get() * number_of_inputs_ + in.get()]
+            : 0;
+    }
+
+    /*!
+     * Bit mask of inputs feeding output \p out with selector set to \p sel.
+     */
+    Word inputs_feeding(const Selector &sel, const Output &out) const
+    {
+        return sel.get() < number_of_choices_ && out.get() < number_of_outputs_
+            ? columns_[sel.get() * number_of_outputs_ + out.get()]
+            : 0;
     }
 };
 
@@ -543,15 +780,22 @@ class MappingTable: public Mapping
 class SwitchingElement: public PathElement
 {
   private:
+    friend Appliance;
+
     std::string selector_;
     std::unique_ptr<Mapping> mapping_;
+    MappingMatrix matrix_;
+
+    /* assigned by #StaticModels::SignalPaths::Appliance */
+    SelectorHandle handle_;
 
     explicit SwitchingElement(std::string &&element_name,
                               std::string &&selector_name,
                               std::unique_ptr<Mapping> mapping):
-        PathElement(std::move(element_name)),
+        PathElement(Kind::SWITCHING, std::move(element_name)),
         selector_(std::move(selector_name)),
-        mapping_(std::move(mapping))
+        mapping_(std::move(mapping)),
+        handle_(SelectorHandle::mk_invalid())
     {
         if(mapping_ == nullptr)
             Error() << "Mapping not provided";
@@ -563,14 +807,16 @@ class SwitchingElement: public PathElement
 
     virtual ~SwitchingElement() = default;
 
-    void finalize(const std::string &device_id) const final override
+    void finalize(const std::string &device_id) final override
     {
         PathElement::finalize(device_id);
         mapping_->finalize(device_id, name_, selector_,
                            sources_.size(), edges_by_output_.size());
+        matrix_ = MappingMatrix(*mapping_);
     }
 
     const std::string &get_selector_name() const { return selector_; }
+    const SelectorHandle &get_selector_handle() const { return handle_; }
 
     bool is_selector_in_range(const Selector &sel) const
     {
@@ -579,9 +825,11 @@ class SwitchingElement: public PathElement
 
     bool is_connected(const Selector &sel, const Input &in, const Output &out) const
     {
-        return mapping_->is_connected(sel, in, out);
+        return matrix_.is_connected(sel, in, out);
     }
 
+    const MappingMatrix &get_matrix() const { return matrix_; }
+
     static SwitchingElement mk_mux(std::string &&element_name,
                                    std::string &&selector_name,
                                    std::vector<Input> &&m)
@@ -607,6 +855,194 @@ class SwitchingElement: public PathElement
     }
 };
 
+const SwitchingElement *PathElement::as_switching_element() const
+{
+    return kind_ == Kind::SWITCHING
+        ? static_cast<const SwitchingElement *>(this)
+        : nullptr;
+}
+
+/*!
+ * Frozen signal path graph in compressed sparse row layout.
+ *
+ * Elements are numbered densely. The outputs of each element which have
+ * outgoing edges are stored contiguously in ascending pad order, followed by
+ * the outputs of the next element. The edges of each output are stored
+ * contiguously as well, in the order they have been connected. Thus, walking
+ * the graph boils down to walking index ranges in three arrays.
+ *
+ * For walking the graph upstream, the incoming edges of each element are
+ * stored contiguously as well, ordered by source element.
+ *
+ * Objects of this class are created by
+ * #StaticModels::SignalPaths::ApplianceBuilder::build().
+ */
+class CompactGraph
+{
+  public:
+    struct OutputPad
+    {
+        uint32_t pad_;
+        uint32_t first_edge_;
+    };
+
+    struct Edge
+    {
+        uint32_t target_;
+        uint32_t target_pad_;
+    };
+
+    struct IncomingEdge
+    {
+        uint32_t source_;
+        uint32_t source_pad_;
+        uint32_t target_pad_;
+    };
+
+  private:
+    std::vector<const PathElement *> elements_;
+
+    /* outputs of element i are [first_output_[i], first_output_[i + 1]) */
+    std::vector<uint32_t> first_output_;
+
+    /* edges of output o are [outputs_[o].first_edge_, outputs_[o + 1].first_edge_),
+     * there is a sentinel at the end */
+    std::vector<OutputPad> outputs_;
+
+    std::vector<Edge> edges_;
+
+    /* incoming edges of element i are [first_incoming_[i], first_incoming_[i + 1]) */
+    std::vector<uint32_t> first_incoming_;
+    std::vector<IncomingEdge> incoming_;
+
+  public:
+    CompactGraph(const CompactGraph &) = delete;
+    CompactGraph(CompactGraph &&) = default;
+    CompactGraph &operator=(const CompactGraph &) = delete;
+    CompactGraph &operator=(CompactGraph &&) = default;
+    explicit CompactGraph() = default;
+
+    /*!
+     * Number the elements and lay out their edges.
+     *
+     * The elements must not be moved in memory after this.
+     */
+    static CompactGraph build(const std::vector<PathElement *> &elements)
+    {
+        CompactGraph g;
+        g.elements_.reserve(elements.size());
+        g.first_output_.reserve(elements.size() + 1);
+
+        for(auto *e : elements)
+        {
+            e->index_ = g.elements_.size();
+            g.elements_.push_back(e);
+        }
+
+        std::vector<const OutgoingEdge *> edges;
+
+        for(const auto *e : elements)
+        {
+            g.first_output_.push_back(g.outputs_.size());
+
+            /* edges are prepended on connect, restore connection order */
+            edges.clear();
+            for(const auto &edge : e->all_outgoing_edges_)
+                edges.push_back(&edge);
+
+            std::reverse(edges.begin(), edges.end());
+            std::stable_sort(edges.begin(), edges.end(),
+                [] (const auto *a, const auto *b)
+                {
+                    return a->get_output_pad() < b->get_output_pad();
+                });
+
+            for(const auto *edge : edges)
+            {
+                if(g.outputs_.size() == g.first_output_.back() ||
+                   g.outputs_.back().pad_ != edge->get_output_pad().get())
+                    g.outputs_.push_back({edge->get_output_pad().get(),
+                                          uint32_t(g.edges_.size())});
+
+                g.edges_.push_back({edge->get_target_element().index_,
+                                    edge->get_target_input_pad().get()});
+            }
+        }
+
+        g.first_output_.push_back(g.outputs_.size());
+        g.outputs_.push_back({Output::mk_unconnected().get(),
+                              uint32_t(g.edges_.size())});
+
+        g.first_incoming_.resize(elements.size() + 1, 0);
+
+        for(const auto &edge : g.edges_)
+            ++g.first_incoming_[edge.target_ + 1];
+
+        for(size_t i = 1; i < g.first_incoming_.size(); ++i)
+            g.first_incoming_[i] += g.first_incoming_[i - 1];
+
+        std::vector<uint32_t> next(g.first_incoming_.begin(),
+                                   g.first_incoming_.end() - 1);
+        g.incoming_.resize(g.edges_.size());
+
+        for(uint32_t src = 0; src < g.elements_.size(); ++src)
+            for(const auto *o = g.outputs_begin(src); o != g.outputs_end(src); ++o)
+                for(const auto *e = g.edges_begin(*o); e != g.edges_end(*o); ++e)
+                    g.incoming_[next[e->target_]++] = {src, o->pad_, e->target_pad_};
+
+        return g;
+    }
+
+    size_t size() const { return elements_.size(); }
+    size_t get_number_of_edges() const { return edges_.size(); }
+
+    const PathElement &get_element(uint32_t idx) const { return *elements_[idx]; }
+
+    bool is_sink(uint32_t idx) const
+    {
+        return first_output_[idx] == first_output_[idx + 1];
+    }
+
+    const OutputPad *outputs_begin(uint32_t idx) const
+    {
+        return &outputs_[first_output_[idx]];
+    }
+
+    const OutputPad *outputs_end(uint32_t idx) const
+    {
+        return &outputs_[first_output_[idx + 1]];
+    }
+
+    const OutputPad *find_output(uint32_t idx, const Output &pad) const
+    {
+        for(const auto *o = outputs_begin(idx); o != outputs_end(idx); ++o)
+            if(o->pad_ == pad.get())
+                return o;
+
+        return nullptr;
+    }
+
+    const Edge *edges_begin(const OutputPad &o) const
+    {
+        return &edges_[o.first_edge_];
+    }
+
+    const Edge *edges_end(const OutputPad &o) const
+    {
+        return edges_.data() + (&o + 1)->first_edge_;
+    }
+
+    const IncomingEdge *incoming_begin(uint32_t idx) const
+    {
+        return incoming_.data() + first_incoming_[idx];
+    }
+
+    const IncomingEdge *incoming_end(uint32_t idx) const
+    {
+        return incoming_.data() + first_incoming_[idx + 1];
+    }
+};
+
 /*!
  * Static signal path graph as defined for an appliance.
  *
@@ -620,6 +1056,8 @@ class Appliance
     std::vector<StaticElement> static_elements_;
     std::vector<SwitchingElement> switching_elements_;
     std::unordered_map<std::string, PathElement &> elements_by_name_;
+    std::vector<std::string> signal_type_names_;
+    CompactGraph graph_;
 
   public:
     Appliance(const Appliance &) = delete;
@@ -630,14 +1068,36 @@ class Appliance
     explicit Appliance(std::string &&name,
                        std::vector<StaticElement> &&static_elements,
                        std::vector<SwitchingElement> &&switching_elements,
-                       std::unordered_map<std::string, PathElement &> &&elements_by_name):
+                       std::unordered_map<std::string, PathElement &> &&elements_by_name,
+                       std::vector<std::string> &&signal_type_names,
+                       CompactGraph &&graph):
         name_(std::move(name)),
         static_elements_(std::move(static_elements)),
         switching_elements_(std::move(switching_elements)),
-        elements_by_name_(std::move(elements_by_name))
-    {}
+        elements_by_name_(std::move(elements_by_name)),
+        signal_type_names_(std::move(signal_type_names)),
+        graph_(std::move(graph))
+    {
+        for(size_t i = 0; i < switching_elements_.size(); ++i)
+            switching_elements_[i].handle_ = SelectorHandle(i);
+    }
 
     const std::string &get_name() const { return name_; }
+    const CompactGraph &get_graph() const { return graph_; }
+
+    size_t get_number_of_elements() const { return graph_.size(); }
+    size_t get_number_of_edges() const { return graph_.get_number_of_edges(); }
+
+    std::vector<std::string> to_names(SignalTypes types) const
+    {
+        std::vector<std::string> result;
+
+        for(size_t i = 0; i < signal_type_names_.size(); ++i)
+            if((types & (SignalTypes(1) << i)) != 0)
+                result.push_back(signal_type_names_[i]);
+
+        return result;
+    }
 
     void for_each_source(const std::function<void(const PathElement &src)> &apply) const
     {
@@ -664,7 +1124,23 @@ class Appliance
 
     const SwitchingElement *lookup_switching_element(const std::string &name) const
     {
-        return dynamic_cast<const SwitchingElement *>(lookup_element(name));
+        const auto *elem = lookup_element(name);
+        return elem != nullptr ? elem->as_switching_element() : nullptr;
+    }
+
+    size_t get_number_of_switching_elements() const { return switching_elements_.size(); }
+
+    const SwitchingElement *lookup_switching_element(const SelectorHandle &handle) const
+    {
+        return handle.get() < switching_elements_.size()
+            ? &switching_elements_[handle.get()]
+            : nullptr;
+    }
+
+    SelectorHandle lookup_selector_handle(const std::string &name) const
+    {
+        const auto *elem = lookup_switching_element(name);
+        return elem != nullptr ? elem->get_selector_handle() : SelectorHandle::mk_invalid();
     }
 };
 
@@ -678,6 +1154,7 @@ class ApplianceBuilder
     std::vector<StaticElement> static_elements_;
     std::vector<SwitchingElement> switching_elements_;
     std::unordered_map<std::string, PathElement &> elements_by_name_;
+    std::vector<std::string> signal_type_names_;
     bool is_adding_elements_allowed_;
 
   public:
@@ -709,6 +1186,26 @@ class ApplianceBuilder
         return elements_by_name_.at(name);
     }
 
+    /*!
+     * Map signal type name to its bit, assign a new bit if necessary.
+     */
+    SignalTypes mk_signal_type(const std::string &type_name)
+    {
+        const auto it(std::find(signal_type_names_.begin(),
+                                signal_type_names_.end(), type_name));
+        const auto idx(std::distance(signal_type_names_.begin(), it));
+
+        if(it == signal_type_names_.end())
+        {
+            if(signal_type_names_.size() >= sizeof(SignalTypes) * 8)
+                Error() << "Too many signal types";
+
+            signal_type_names_.push_back(type_name);
+        }
+
+        return SignalTypes(1) << idx;
+    }
+
     void no_more_elements()
     {
         if(!is_adding_elements_allowed_)
@@ -732,10 +1229,23 @@ class ApplianceBuilder
         for(auto &e : elements_by_name_)
             e.second.finalize(name_);
 
+        std::vector<PathElement *> elements;
+        elements.reserve(static_elements_.size() + switching_elements_.size());
+
+        for(auto &e : static_elements_)
+            elements.push_back(&e);
+
+        for(auto &e : switching_elements_)
+            elements.push_back(&e);
+
+        auto graph(CompactGraph::build(elements));
+
         return Appliance(std::move(name_),
                          std::move(static_elements_),
                          std::move(switching_elements_),
-                         std::move(elements_by_name_));
+                         std::move(elements_by_name_),
+                         std::move(signal_type_names_),
+                         std::move(graph));
     }
 };
 
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STATE_SHM_HH
+#define STATE_SHM_HH
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+ * Publication of the current state through a shared memory region.
+ *
+ * The region consists of a fixed #StateSHM::Header followed by the payload, a
+ * JSON document as UTF-8 string. The payload is protected by a sequence lock:
+ * the writer makes the sequence counter odd before touching the payload and
+ * even after it is done, readers retry until they have copied the payload
+ * without the counter changing in between. Readers never block the writer,
+ * and a reader with an established mapping needs no system calls at all.
+ */
+namespace StateSHM
+{
+
+/*! Default name of the shared memory object as passed to \c shm_open(). */
+static constexpr const char *DEFAULT_NAME = "/aupad-state";
+
+/*! Default payload capacity of the region in bytes. */
+static constexpr size_t DEFAULT_CAPACITY = 256U * 1024U;
+
+static constexpr uint32_t MAGIC = 0x41755061;
+static constexpr uint32_t VERSION = 1;
+
+struct alignas(64) Header
+{
+    uint32_t magic_;
+    uint32_t version_;
+    uint32_t capacity_;
+
+    /*! Sequence lock, odd while the writer is updating the payload. */
+    std::atomic<uint32_t> sequence_;
+
+    /*! Number of valid payload bytes. */
+    std::atomic<uint32_t> length_;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "sequence counter must be lock-free to work across processes");
+
+static inline char *payload_of(Header *h)
+{
+    return reinterpret_cast<char *>(h) + sizeof(Header);
+}
+
+static inline const char *payload_of(const Header *h)
+{
+    return reinterpret_cast<const char *>(h) + sizeof(Header);
+}
+
+}
+
+#endif /* !STATE_SHM_HH */
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "state_shm_reader.hh"
+#include "error.hh"
+
+#include <cstring>
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+StateSHM::Reader::Reader(std::string &&name):
+    name_(std::move(name)),
+    header_(nullptr),
+    mapped_size_(0),
+    last_sequence_(0)
+{
+    open();
+}
+
+StateSHM::Reader::~Reader()
+{
+    close();
+}
+
+void StateSHM::Reader::open()
+{
+    const int fd = shm_open(name_.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if(fd < 0)
+        Error() << "failed opening shared memory \"" << name_ << "\": "
+                << strerror(errno);
+
+    struct stat st;
+    if(fstat(fd, &st) < 0 || size_t(st.st_size) < sizeof(Header))
+    {
+        ::close(fd);
+        Error() << "shared memory \"" << name_ << "\" has invalid size";
+    }
+
+    void *mem = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    const int err = errno;
+    ::close(fd);
+
+    if(mem == MAP_FAILED)
+        Error() << "failed mapping shared memory \"" << name_ << "\": "
+                << strerror(err);
+
+    const auto *h = static_cast<const Header *>(mem);
+
+    if(h->magic_ != MAGIC || h->version_ != VERSION ||
+       sizeof(Header) + h->capacity_ > size_t(st.st_size))
+    {
+        munmap(mem, st.st_size);
+        Error() << "shared memory \"" << name_ << "\" has unexpected format";
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    header_ = h;
+    mapped_size_ = st.st_size;
+    last_sequence_ = 0;
+}
+
+void StateSHM::Reader::close()
+{
+    if(header_ == nullptr)
+        return;
+
+    munmap(const_cast<Header *>(header_), mapped_size_);
+    header_ = nullptr;
+    mapped_size_ = 0;
+}
+
+void StateSHM::Reader::reopen()
+{
+    close();
+    open();
+}
+
+bool StateSHM::Reader::has_changed() const
+{
+    return header_->sequence_.load(std::memory_order_acquire) != last_sequence_;
+}
+
+/*!
+ * Copy a consistent snapshot of the published state.
+ *
+ * \param payload
+ *     The snapshot is copied to here. It remains untouched unless
+ *     #StateSHM::ReadResult::OK is returned.
+ *
+ * \param only_if_changed
+ *     If true, skip copying if nothing has changed since the last successful
+ *     read and return #StateSHM::ReadResult::UNCHANGED.
+ *
+ * \param max_attempts
+ *     How many times to retry if the writer interferes.
+ */
+StateSHM::ReadResult
+StateSHM::Reader::read(std::string &payload, bool only_if_changed,
+                       unsigned int max_attempts)
+{
+    std::string buffer;
+
+    for(unsigned int attempt = 0; attempt < max_attempts; ++attempt)
+    {
+        if(header_->magic_ != MAGIC)
+            return ReadResult::RETIRED;
+
+        const auto seq_before = header_->sequence_.load(std::memory_order_acquire);
+
+        if((seq_before & 1U) != 0)
+            continue;
+
+        if(seq_before == 0)
+            return ReadResult::EMPTY;
+
+        if(only_if_changed && seq_before == last_sequence_)
+            return ReadResult::UNCHANGED;
+
+        const auto length = header_->length_.load(std::memory_order_relaxed);
+        if(length <= header_->capacity_)
+            buffer.assign(payload_of(header_), length);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if(header_->sequence_.load(std::memory_order_relaxed) != seq_before)
+            continue;
+
+        if(length > header_->capacity_)
+            return ReadResult::EMPTY;
+
+        last_sequence_ = seq_before;
+
+        if(length == 0)
+            return ReadResult::EMPTY;
+
+        payload = std::move(buffer);
+        return ReadResult::OK;
+    }
+
+    return ReadResult::BUSY;
+}
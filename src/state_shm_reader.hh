@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STATE_SHM_READER_HH
+#define STATE_SHM_READER_HH
+
+#include "state_shm.hh"
+
+#include <string>
+
+namespace StateSHM
+{
+
+enum class ReadResult
+{
+    OK,         /*!< Consistent snapshot has been copied. */
+    UNCHANGED,  /*!< Nothing has changed since the last successful read. */
+    EMPTY,      /*!< Writer has not published anything (yet). */
+    BUSY,       /*!< Writer kept updating while we tried to read, try again. */
+    RETIRED,    /*!< Writer has gone away, region must be reopened. */
+};
+
+/*!
+ * Read-only access to the state published by AuPaD.
+ *
+ * Reading does not involve any system calls once the object has been
+ * constructed. Objects of this class are not thread-safe; use one object per
+ * thread.
+ */
+class Reader
+{
+  private:
+    std::string name_;
+    const Header *header_;
+    size_t mapped_size_;
+    uint32_t last_sequence_;
+
+  public:
+    Reader(const Reader &) = delete;
+    Reader(Reader &&) = delete;
+    Reader &operator=(const Reader &) = delete;
+    Reader &operator=(Reader &&) = delete;
+
+    /*!
+     * Map shared memory object read-only. Throws on error.
+     */
+    explicit Reader(std::string &&name = DEFAULT_NAME);
+
+    ~Reader();
+
+    /*!
+     * Whether or not there is a new snapshot since the last successful read.
+     */
+    bool has_changed() const;
+
+    ReadResult read(std::string &payload, bool only_if_changed = false,
+                    unsigned int max_attempts = 64);
+
+    void reopen();
+
+  private:
+    void open();
+    void close();
+};
+
+}
+
+#endif /* !STATE_SHM_READER_HH */
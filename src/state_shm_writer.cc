@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "state_shm_writer.hh"
+#include "error.hh"
+#include "messages.h"
+
+#include <cstring>
+#include <cerrno>
+#include <limits>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ * Mark region left behind by a previous instance as retired so that its
+ * readers know they should reopen, then remove it.
+ */
+static void retire_stale_region(const std::string &name)
+{
+    const int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if(fd < 0)
+        return;
+
+    struct stat st;
+    if(fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(StateSHM::Header))
+    {
+        void *mem = mmap(nullptr, sizeof(StateSHM::Header),
+                         PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(mem != MAP_FAILED)
+        {
+            static_cast<StateSHM::Header *>(mem)->magic_ = 0;
+            munmap(mem, sizeof(StateSHM::Header));
+        }
+    }
+
+    close(fd);
+    shm_unlink(name.c_str());
+}
+
+StateSHM::Writer::Writer(std::string &&name, size_t capacity):
+    name_(std::move(name)),
+    header_(nullptr),
+    mapped_size_(sizeof(Header) + capacity)
+{
+    if(capacity > std::numeric_limits<uint32_t>::max())
+        Error() << "capacity " << capacity << " too large for shared memory";
+
+    retire_stale_region(name_);
+
+    const int fd = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC,
+                            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if(fd < 0)
+        Error() << "failed creating shared memory \"" << name_ << "\": "
+                << strerror(errno);
+
+    if(ftruncate(fd, mapped_size_) < 0)
+    {
+        const int err = errno;
+        close(fd);
+        shm_unlink(name_.c_str());
+        Error() << "failed sizing shared memory \"" << name_ << "\": "
+                << strerror(err);
+    }
+
+    void *mem = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     fd, 0);
+    const int err = errno;
+    close(fd);
+
+    if(mem == MAP_FAILED)
+    {
+        shm_unlink(name_.c_str());
+        Error() << "failed mapping shared memory \"" << name_ << "\": "
+                << strerror(err);
+    }
+
+    header_ = new(mem) Header;
+    header_->capacity_ = capacity;
+    header_->sequence_.store(0, std::memory_order_relaxed);
+    header_->length_.store(0, std::memory_order_relaxed);
+    header_->version_ = VERSION;
+
+    /* readers check the magic last, so it goes in last */
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic_ = MAGIC;
+}
+
+StateSHM::Writer::~Writer()
+{
+    if(header_ == nullptr)
+        return;
+
+    header_->magic_ = 0;
+    munmap(header_, mapped_size_);
+    shm_unlink(name_.c_str());
+}
+
+/*!
+ * Replace the payload in shared memory.
+ *
+ * \returns
+ *     True on success, false if the payload does not fit into the region. In
+ *     the latter case, the region is marked as empty.
+ */
+bool StateSHM::Writer::publish(const std::string &payload)
+{
+    const bool fits = payload.size() <= header_->capacity_;
+    const auto seq = header_->sequence_.load(std::memory_order_relaxed);
+
+    header_->sequence_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if(fits)
+    {
+        std::copy(payload.begin(), payload.end(), payload_of(header_));
+        header_->length_.store(payload.size(), std::memory_order_relaxed);
+    }
+    else
+        header_->length_.store(0, std::memory_order_relaxed);
+
+    header_->sequence_.store(seq + 2, std::memory_order_release);
+
+    if(!fits)
+        msg_error(0, LOG_ERR,
+                  "State of size %zu too large for shared memory (capacity %u)",
+                  payload.size(), header_->capacity_);
+
+    return fits;
+}
+
+uint32_t StateSHM::Writer::get_sequence() const
+{
+    return header_->sequence_.load(std::memory_order_relaxed);
+}
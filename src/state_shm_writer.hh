@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef STATE_SHM_WRITER_HH
+#define STATE_SHM_WRITER_HH
+
+#include "state_shm.hh"
+
+#include <string>
+
+namespace StateSHM
+{
+
+/*!
+ * Owner of the shared memory region, used by the daemon.
+ *
+ * There must be only one writer per region.
+ */
+class Writer
+{
+  private:
+    std::string name_;
+    Header *header_;
+    size_t mapped_size_;
+
+  public:
+    Writer(const Writer &) = delete;
+    Writer(Writer &&) = delete;
+    Writer &operator=(const Writer &) = delete;
+    Writer &operator=(Writer &&) = delete;
+
+    /*!
+     * Create shared memory object and map it.
+     *
+     * An existing object of the same name is replaced. Throws on error.
+     */
+    explicit Writer(std::string &&name, size_t capacity = DEFAULT_CAPACITY);
+
+    ~Writer();
+
+    bool publish(const std::string &payload);
+    uint32_t get_sequence() const;
+};
+
+}
+
+#endif /* !STATE_SHM_WRITER_HH */
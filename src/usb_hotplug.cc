@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "usb_hotplug.hh"
+#include "device_models.hh"
+#include "error.hh"
+#include "messages.h"
+
+static const std::string sysfs_usb_devices("/sys/bus/usb/devices/");
+
+std::string
+USBHotplug::EventProcessor::normalize_device_path(const std::string &device_path)
+{
+    if(device_path.compare(0, sysfs_usb_devices.length(), sysfs_usb_devices) == 0)
+        return device_path;
+
+    const auto sep(device_path.find_last_of('/'));
+    return sep == std::string::npos
+        ? sysfs_usb_devices + device_path
+        : sysfs_usb_devices + device_path.substr(sep + 1);
+}
+
+nlohmann::json
+USBHotplug::EventProcessor::to_json(const StaticModels::UsbConnector &conn)
+{
+    nlohmann::json result;
+    result["id"] = conn.id_;
+    result["label"] = conn.label_;
+    result["device_path"] = conn.device_path_;
+    result["location"] = conn.location_;
+
+    if(!conn.audio_source_.empty())
+        result["audio_source"] = conn.audio_source_;
+
+    return result;
+}
+
+/*!
+ * Find connector for given device path in the current appliance model.
+ *
+ * This is a plain hash table lookup.
+ */
+const StaticModels::UsbConnector *
+USBHotplug::EventProcessor::resolve(const std::string &device_path) const
+{
+    const auto *model = get_model_();
+    return model != nullptr
+        ? model->get_usb_connectors().lookup_by_device_path(
+                                        normalize_device_path(device_path))
+        : nullptr;
+}
+
+/*!
+ * Process single hotplug event.
+ *
+ * \returns
+ *     True if the event has been passed on to the notification function,
+ *     false if it was ignored.
+ */
+bool USBHotplug::EventProcessor::process(Action action,
+                                         const std::string &device_path)
+{
+    auto path(normalize_device_path(device_path));
+    nlohmann::json event;
+
+    switch(action)
+    {
+      case Action::ADD:
+        {
+            const auto *conn = resolve(path);
+            if(conn == nullptr)
+            {
+                msg_vinfo(MESSAGE_LEVEL_DEBUG,
+                          "USB device %s is not on any known connector",
+                          path.c_str());
+                return false;
+            }
+
+            auto conn_json(to_json(*conn));
+            const auto it(plugged_.find(path));
+            if(it != plugged_.end() && it->second == conn_json)
+                return false;
+
+            plugged_[path] = conn_json;
+            event["action"] = "add";
+            event["connector"] = std::move(conn_json);
+        }
+
+        break;
+
+      case Action::REMOVE:
+        {
+            const auto it(plugged_.find(path));
+            if(it == plugged_.end())
+                return false;
+
+            event["action"] = "remove";
+            event["connector"] = std::move(it->second);
+            plugged_.erase(it);
+        }
+
+        break;
+    }
+
+    if(notify_ != nullptr)
+        notify_(event);
+
+    return true;
+}
+
+/*!
+ * Process hotplug event in text form.
+ *
+ * Empty lines and lines starting with '#' are ignored.
+ */
+bool USBHotplug::EventProcessor::process_line(const std::string &line)
+{
+    const auto end(line.find_last_not_of(" \t\r\n"));
+    if(end == std::string::npos || line[0] == '#')
+        return false;
+
+    const auto sep(line.find(' '));
+    const auto path_start(sep != std::string::npos
+                          ? line.find_first_not_of(' ', sep)
+                          : std::string::npos);
+
+    if(path_start == std::string::npos || path_start > end)
+    {
+        msg_error(0, LOG_NOTICE, "Invalid USB hotplug event \"%s\"", line.c_str());
+        return false;
+    }
+
+    const auto action(line.substr(0, sep));
+    const auto path(line.substr(path_start, end - path_start + 1));
+
+    if(action == "add")
+        return process(Action::ADD, path);
+    else if(action == "remove")
+        return process(Action::REMOVE, path);
+
+    msg_error(0, LOG_NOTICE, "Invalid USB hotplug action \"%s\"", action.c_str());
+    return false;
+}
+
+/*!
+ * Process hotplug event in JSON form.
+ *
+ * The event is an object with fields "action" and "device_path", as sent in
+ * D-Bus requests.
+ *
+ * 	hrows nlohmann::json::exception
+ *     The event lacks a field or a field is not a string.
+ *
+ * 	hrows std::runtime_error
+ *     The action is neither "add" nor "remove".
+ */
+bool USBHotplug::EventProcessor::process_json(const nlohmann::json &event)
+{
+    const auto action(event.at("action").get<std::string>());
+    const auto &path(event.at("device_path").get_ref<const std::string &>());
+
+    if(action == "add")
+        return process(Action::ADD, path);
+    else if(action == "remove")
+        return process(Action::REMOVE, path);
+
+    Error() << "invalid USB hotplug action \"" << action << "\"";
+}
+
+/*!
+ * Process all hotplug events available from a stream.
+ *
+ * \returns
+ *     Number of events passed on to the notification function.
+ */
+size_t USBHotplug::EventProcessor::process_stream(std::istream &in)
+{
+    size_t count = 0;
+    std::string line;
+
+    while(std::getline(in, line))
+        if(process_line(line))
+            ++count;
+
+    return count;
+}
+
+/*!
+ * All connectors with a USB device plugged in.
+ */
+nlohmann::json USBHotplug::EventProcessor::json() const
+{
+    nlohmann::json result = nlohmann::json::array();
+
+    for(const auto &p : plugged_)
+        result.push_back(p.second);
+
+    return result;
+}
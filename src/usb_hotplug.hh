@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef USB_HOTPLUG_HH
+#define USB_HOTPLUG_HH
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wswitch-enum"
+#pragma GCC diagnostic ignored "-Wtype-limits"
+#ifdef __clang__
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+#endif /* __clang__ */
+#include "json.hh"
+#pragma GCC diagnostic pop
+
+#include <functional>
+#include <istream>
+#include <map>
+#include <string>
+
+namespace StaticModels
+{
+    class DeviceModel;
+    class UsbConnector;
+}
+
+namespace USBHotplug
+{
+
+enum class Action
+{
+    ADD,
+    REMOVE,
+};
+
+/*!
+ * Map USB hotplug events to the connectors defined in the appliance model.
+ *
+ * Events consist of an action and the sysfs path of the USB device. They are
+ * passed in directly, or as text lines of the form "add <path>" and
+ * "remove <path>" (such as written into a FIFO by a udev rule, or by a test).
+ * Kernel device paths as found in udev's DEVPATH are accepted as well; these
+ * are mapped to the /sys/bus/usb/devices/ form used in the models.
+ *
+ * Each event which can be resolved to a connector is passed on to a
+ * notification function as JSON object. The connectors currently in use are
+ * remembered, so that removal is reported even if the model has changed in
+ * the meantime.
+ */
+class EventProcessor
+{
+  public:
+    using GetModelFn = std::function<const StaticModels::DeviceModel *()>;
+    using NotifyFn = std::function<void(const nlohmann::json &event)>;
+
+  private:
+    const GetModelFn get_model_;
+    const NotifyFn notify_;
+    std::map<std::string, nlohmann::json> plugged_;
+
+  public:
+    EventProcessor(const EventProcessor &) = delete;
+    EventProcessor(EventProcessor &&) = default;
+    EventProcessor &operator=(const EventProcessor &) = delete;
+    EventProcessor &operator=(EventProcessor &&) = delete;
+
+    explicit EventProcessor(GetModelFn &&get_model, NotifyFn &&notify):
+        get_model_(std::move(get_model)),
+        notify_(std::move(notify))
+    {}
+
+    const StaticModels::UsbConnector *resolve(const std::string &device_path) const;
+    bool process(Action action, const std::string &device_path);
+    bool process_line(const std::string &line);
+    bool process_json(const nlohmann::json &event);
+    size_t process_stream(std::istream &in);
+    nlohmann::json json() const;
+
+    static std::string normalize_device_path(const std::string &device_path);
+    static nlohmann::json to_json(const StaticModels::UsbConnector &conn);
+};
+
+}
+
+#endif /* !USB_HOTPLUG_HH */
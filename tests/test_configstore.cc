@@ -28,22 +28,34 @@
 #include "configstore.hh"
 #include "configstore_json.hh"
 #include "configstore_changes.hh"
+#include "configstore_iter.hh"
 #include "device_models.hh"
+#include "models_reload.hh"
+#include "client_plugin_manager.hh"
+#include "usb_hotplug.hh"
 
 #include "mock_messages.hh"
 
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <algorithm>
+#include <cstdio>
+
 TEST_SUITE_BEGIN("Configuration store");
 
 class Fixture
 {
   protected:
     StaticModels::DeviceModelsDatabase models;
+    StaticModels::DeviceModelCache model_cache;
     ConfigStore::Settings settings;
     std::unique_ptr<MockMessages::Mock> mock_messages;
 
   public:
     explicit Fixture():
-        settings(models),
+        model_cache(models),
+        settings(model_cache),
         mock_messages(std::make_unique<MockMessages::Mock>())
     {
         MockMessages::singleton = mock_messages.get();
@@ -190,6 +202,98 @@ TEST_CASE_FIXTURE(Fixture, "Copy properties are resolved when asked to")
     }
 }
 
+TEST_CASE_FIXTURE(Fixture, "Predefined elements are expanded when asked to")
+{
+    CHECK(models.loads(R"(
+    {
+        "all_devices": {
+            "Amp": {
+                "audio_sources": [{ "id": "in" }],
+                "audio_sinks": [{ "id": "out" }],
+                "elements": [
+                    {
+                        "id": "eq1",
+                        "element": {
+                            "predefined": "Amp.eq",
+                            "description": "First EQ", "table": [1, 2]
+                        }
+                    },
+                    {
+                        "id": "eq2",
+                        "element": {
+                            "predefined": "Amp.eq",
+                            "description": "Second EQ", "table": [3, 4]
+                        }
+                    }
+                ],
+                "audio_signal_paths": [
+                    { "connections": { "in": "eq1", "eq1": "eq2", "eq2": "out" } }
+                ],
+                "predefined_elements": {
+                    "eq": {
+                        "parameters": [ "$description", "$table" ],
+                        "controls": {
+                            "frequency": {
+                                "type": "range", "value_type": "y",
+                                "min": 0, "max": 1, "step": 1, "scale": "steps",
+                                "mapped_to_scales": { "Hz": { "table": "$table" } }
+                            },
+                            "level": {
+                                "type": "range", "value_type": "y",
+                                "min": 0, "max": 7, "step": 1, "scale": "steps"
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    })"));
+
+    models.flatten();
+
+    const auto &def(models.get_device_model_definition("Amp"));
+    const auto &eq1(def["elements"][0]["element"]);
+    CHECK(eq1.find("predefined") == eq1.end());
+    CHECK(eq1.find("parameters") == eq1.end());
+    CHECK(eq1.find("table") == eq1.end());
+    CHECK(eq1["description"] == "First EQ");
+    CHECK(eq1["controls"]["frequency"]["mapped_to_scales"]["Hz"]["table"] ==
+          nlohmann::json::array({1, 2}));
+    CHECK(def["elements"][1]["element"]["controls"]["frequency"]["mapped_to_scales"]["Hz"]["table"] ==
+          nlohmann::json::array({3, 4}));
+
+    const auto *amp = model_cache.get_device_model("Amp");
+    REQUIRE(amp != nullptr);
+    const auto *elem1 = amp->lookup_internal_element("eq1");
+    const auto *elem2 = amp->lookup_internal_element("eq2");
+    REQUIRE(elem1 != nullptr);
+    REQUIRE(elem2 != nullptr);
+    CHECK(elem1->description_ == "First EQ");
+    CHECK(elem2->description_ == "Second EQ");
+
+    /* identical controls are shared, different ones are not */
+    REQUIRE(elem1->get_control_ptr("level") != nullptr);
+    CHECK(elem1->get_control_ptr("level") == elem2->get_control_ptr("level"));
+    REQUIRE(elem1->get_control_ptr("frequency") != nullptr);
+    CHECK(elem1->get_control_ptr("frequency") != elem2->get_control_ptr("frequency"));
+}
+
+TEST_CASE_FIXTURE(Fixture, "Unknown predefined elements are rejected")
+{
+    CHECK(models.loads(R"(
+    {
+        "all_devices": {
+            "Amp": {
+                "elements": [
+                    { "id": "eq", "element": { "predefined": "Amp.missing" } }
+                ]
+            }
+        }
+    })"));
+
+    CHECK_THROWS(models.flatten());
+}
+
 TEST_CASE_FIXTURE(Fixture, "Newly created configuration store is empty")
 {
     expect_equal(nlohmann::json({}));
@@ -1545,4 +1649,1221 @@ TEST_CASE_FIXTURE(Fixture, "Clearing settings also clears the log")
     CHECK_FALSE(js.extract_changes(changes));
 }
 
+static const auto full_state_declaration = R"(
+    {
+        "audio_path_changes": [
+            { "op": "clear_instances" },
+            { "op": "add_instance", "name": "self", "id": "MP3100HV" },
+            { "op": "add_instance", "name": "amp", "id": "PA3100HV" },
+            { "op": "set", "element": "self.dac", "kv": {
+                "filter": { "type": "s", "value": "bezier" },
+                "level": { "type": "Y", "value": -3 }
+            } },
+            { "op": "connect", "from": "self.analog_out", "to": "amp.in_line" }
+        ]
+    })";
+
+TEST_CASE_FIXTURE(Fixture, "Identical full state replacement does not report any changes")
+{
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+                                   "No model defined for device ID \"%s\"", true);
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+                                   "No model defined for device ID \"%s\"", true);
+    settings.update(full_state_declaration);
+    const auto expected_json(nlohmann::json::parse(settings.json_string()));
+
+    {
+    ConfigStore::Changes changes;
+    ConfigStore::SettingsJSON js(settings);
+    CHECK(js.extract_changes(changes));
+    }
+
+    settings.update(full_state_declaration,
+                    ConfigStore::Settings::UpdateMode::REPLACE_ALL);
+    expect_equal(expected_json);
+
+    {
+    ConfigStore::Changes changes;
+    ConfigStore::SettingsJSON js(settings);
+    CHECK_FALSE(js.extract_changes(changes));
+    }
+
+    settings.update(full_state_declaration,
+                    ConfigStore::Settings::UpdateMode::DETECT_FULL_STATE);
+    expect_equal(expected_json);
+
+    ConfigStore::Changes changes;
+    ConfigStore::SettingsJSON js(settings);
+    CHECK_FALSE(js.extract_changes(changes));
+}
+
+TEST_CASE_FIXTURE(Fixture, "Full state replacement reports only differences")
+{
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+                                   "No model defined for device ID \"%s\"", true);
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+                                   "No model defined for device ID \"%s\"", true);
+    settings.update(full_state_declaration);
+
+    {
+    ConfigStore::Changes changes;
+    ConfigStore::SettingsJSON js(settings);
+    CHECK(js.extract_changes(changes));
+    }
+
+    const auto input = R"(
+        {
+            "audio_path_changes": [
+                { "op": "clear_instances" },
+                { "op": "add_instance", "name": "self", "id": "MP3100HV" },
+                { "op": "add_instance", "name": "amp", "id": "PA3100HV" },
+                { "op": "add_instance", "name": "sub", "id": "Subwoofer" },
+                { "op": "set", "element": "self.dac", "kv": {
+                    "filter": { "type": "s", "value": "bezier" },
+                    "level": { "type": "Y", "value": -5 }
+                } },
+                { "op": "connect", "from": "self.analog_out", "to": "sub.in" }
+            ]
+        })";
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+                                   "No model defined for device ID \"%s\"", true);
+    settings.update(input, ConfigStore::Settings::UpdateMode::DETECT_FULL_STATE);
+
+    const auto expected_json = R"(
+        {
+            "devices": { "self": "MP3100HV", "amp": "PA3100HV", "sub": "Subwoofer" },
+            "settings": {
+                "self": {
+                    "dac": {
+                        "filter": { "type": "s", "value": "bezier" },
+                        "level": { "type": "Y", "value": -5 }
+                    }
+                }
+            },
+            "connections": { "self": { "analog_out": ["sub.in"] } }
+        })"_json;
+    expect_equal(expected_json);
+
+    ConfigStore::Changes changes;
+    ConfigStore::SettingsJSON js(settings);
+    CHECK(js.extract_changes(changes));
+
+    std::vector<std::pair<std::string, bool>> reported_devices;
+    changes.for_each_changed_device(
+        [&reported_devices] (const auto &name, bool was_added)
+        { reported_devices.emplace_back(name, was_added); });
+    REQUIRE(reported_devices.size() == 1);
+    CHECK(reported_devices[0].first == "sub");
+    CHECK(reported_devices[0].second);
+
+    std::vector<std::tuple<std::string, std::string, bool>> reported_connections;
+    changes.for_each_changed_connection(
+        [&reported_connections]
+        (const auto &from, const auto &to, bool was_added)
+        { reported_connections.emplace_back(from, to, was_added); });
+    std::sort(reported_connections.begin(), reported_connections.end());
+    REQUIRE(reported_connections.size() == 2);
+    CHECK(reported_connections[0] == std::make_tuple("self.analog_out", "amp.in_line", false));
+    CHECK(reported_connections[1] == std::make_tuple("self.analog_out", "sub.in", true));
+
+    std::vector<std::string> reported_values;
+    changes.for_each_changed_value(
+        [&reported_values]
+        (const auto &name, const auto &old_value, const auto &new_value)
+        {
+            reported_values.push_back(name);
+            CHECK(old_value.get_value() == -3);
+            CHECK(new_value.get_value() == -5);
+        });
+    REQUIRE(reported_values.size() == 1);
+    CHECK(reported_values[0] == "self.dac.level");
+}
+
+TEST_CASE_FIXTURE(Fixture, "Invalidated settings are dropped by incremental update")
+{
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+                                   "No model defined for device ID \"%s\"", true);
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+                                   "No model defined for device ID \"%s\"", true);
+    settings.update(full_state_declaration);
+
+    {
+    ConfigStore::Changes changes;
+    ConfigStore::SettingsJSON js(settings);
+    CHECK(js.extract_changes(changes));
+    }
+
+    CHECK_FALSE(settings.is_stale());
+    settings.invalidate();
+    CHECK(settings.is_stale());
+
+    const auto input = R"(
+        {
+            "audio_path_changes": [
+                { "op": "add_instance", "name": "self", "id": "MP3100HV" }
+            ]
+        })";
+    settings.update(input, ConfigStore::Settings::UpdateMode::DETECT_FULL_STATE);
+    expect_equal(R"({ "devices": { "self": "MP3100HV" } })"_json);
+    CHECK_FALSE(settings.is_stale());
+}
+
+TEST_CASE_FIXTURE(Fixture, "Invalidated settings stay invalid after failed full state declaration")
+{
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+                                   "No model defined for device ID \"%s\"", true);
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+                                   "No model defined for device ID \"%s\"", true);
+    settings.update(full_state_declaration);
+
+    {
+    ConfigStore::Changes changes;
+    ConfigStore::SettingsJSON js(settings);
+    CHECK(js.extract_changes(changes));
+    }
+
+    settings.invalidate();
+
+    const auto bad_declaration = R"(
+        {
+            "audio_path_changes": [
+                { "op": "clear_instances" },
+                { "op": "add_instance", "name": "self", "id": "MP3100HV" },
+                { "op": "explode" }
+            ]
+        })";
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+                                   "invalid audio path change op \"explode\"", false);
+    settings.update(bad_declaration, ConfigStore::Settings::UpdateMode::DETECT_FULL_STATE);
+    CHECK(settings.is_stale());
+
+    const auto input = R"(
+        {
+            "audio_path_changes": [
+                { "op": "add_instance", "name": "player", "id": "MP3100HV" }
+            ]
+        })";
+    settings.update(input, ConfigStore::Settings::UpdateMode::DETECT_FULL_STATE);
+    expect_equal(R"({ "devices": { "player": "MP3100HV" } })"_json);
+}
+
+TEST_CASE_FIXTURE(Fixture, "Clearing settings keeps device models")
+{
+    const auto input = R"(
+        {
+            "audio_path_changes": [
+                { "op": "add_instance", "name": "self", "id": "MP3100HV" }
+            ]
+        })";
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+                                   "No model defined for device ID \"%s\"", true);
+    settings.update(input);
+    CHECK(model_cache.size() == 1);
+
+    settings.clear();
+    expect_equal(nlohmann::json({}));
+    CHECK(model_cache.size() == 1);
+
+    /* model lookup is not repeated, so there is no message this time */
+    settings.update(input);
+    expect_equal(R"({ "devices": { "self": "MP3100HV" } })"_json);
+
+    /* a model which has actually been built survives clearing as well */
+    if(!models.load("test_models.json", true))
+        models.load("tests/test_models.json");
+
+    const auto real_input = R"(
+        {
+            "audio_path_changes": [
+                { "op": "add_instance", "name": "player", "id": "CalaCDR" }
+            ]
+        })";
+    settings.update(real_input);
+
+    const auto *model =
+        ConfigStore::SettingsIterator(settings).with_device("player").get_model();
+    REQUIRE(model != nullptr);
+    CHECK(model_cache.size() == 2);
+
+    settings.clear();
+    expect_equal(nlohmann::json({}));
+    CHECK(model_cache.size() == 2);
+    CHECK(model_cache.get_device_model("CalaCDR") == model);
+    CHECK(model->name_ == "CalaCDR");
+    CHECK(model->get_signal_path_graph().get_number_of_elements() > 0);
+
+    settings.update(real_input);
+    CHECK(ConfigStore::SettingsIterator(settings).with_device("player").get_model() == model);
+}
+
+TEST_CASE_FIXTURE(Fixture, "Choice values are stored as index")
+{
+    if(!models.load("test_models.json", true))
+        models.load("tests/test_models.json");
+
+    const auto input = R"(
+        {
+            "audio_path_changes": [
+                { "op": "add_instance", "name": "self", "id": "MP3100HV" },
+                {
+                    "op": "set", "element": "self.input_select",
+                    "kv": { "sel": { "type": "s", "value": "usb" } }
+                },
+                {
+                    "op": "set", "element": "self.whatever",
+                    "kv": { "my_param": { "type": "s", "value": "usb" } }
+                }
+            ]
+        })";
+    settings.update(input);
+
+    ConfigStore::Changes changes;
+    ConfigStore::SettingsJSON js(settings);
+    CHECK(js.extract_changes(changes));
+
+    std::vector<std::string> reported_values;
+    changes.for_each_changed_value(
+        [&reported_values]
+        (const auto &name, const auto &old_value, const auto &new_value)
+        {
+            reported_values.push_back(name);
+
+            if(name == "self.input_select.sel")
+            {
+                CHECK(new_value.get_choice_index() == 9);
+                CHECK(new_value.get_string() == "usb");
+                CHECK(new_value == ConfigStore::Value::mk_string("usb"));
+            }
+            else
+            {
+                CHECK_THROWS(new_value.get_choice_index());
+                CHECK(new_value == ConfigStore::Value::mk_string("usb"));
+            }
+        });
+    REQUIRE(reported_values.size() == 2);
+
+    expect_equal(R"(
+        {
+            "devices": { "self": "MP3100HV" },
+            "settings": {
+                "self": {
+                    "input_select": { "sel": { "type": "s", "value": "usb" } },
+                    "whatever": { "my_param": { "type": "s", "value": "usb" } }
+                }
+            }
+        })"_json);
+}
+
+TEST_CASE_FIXTURE(Fixture, "Range values are converted to scales defined in the model")
+{
+    if(!models.load("test_models.json", true))
+        models.load("tests/test_models.json");
+
+    const auto input = R"(
+        {
+            "audio_path_changes": [
+                { "op": "add_instance", "name": "self", "id": "CalaCDR" },
+                {
+                    "op": "set", "element": "self.dsp",
+                    "kv": {
+                        "analog_1_in_level": { "type": "y", "value": 2 },
+                        "analog_2_in_level": { "type": "y", "value": 7 },
+                        "analog_2_phono_in_level": { "type": "y", "value": 0 }
+                    }
+                }
+            ]
+        })";
+    settings.update(input);
+
+    expect_equal(R"(
+        {
+            "devices": { "self": "CalaCDR" },
+            "settings": {
+                "self": {
+                    "dsp": {
+                        "analog_1_in_level": {
+                            "type": "y", "value": 2, "scales": { "mV": 2000.0 }
+                        },
+                        "analog_2_in_level": { "type": "y", "value": 7 },
+                        "analog_2_phono_in_level": {
+                            "type": "y", "value": 0, "scales": { "mV": 2.5 }
+                        }
+                    }
+                }
+            }
+        })"_json);
+
+    const ConfigStore::SettingsIterator si(settings);
+    const auto dev(si.with_device("self"));
+    double result = 0.0;
+    CHECK(dev.get_control_value_in_scale("dsp", "analog_1_in_level", "mV", result));
+    CHECK(result == 2000.0);
+    CHECK_FALSE(dev.get_control_value_in_scale("dsp", "analog_1_in_level", "Hz", result));
+    CHECK_FALSE(dev.get_control_value_in_scale("dsp", "analog_2_in_level", "mV", result));
+    CHECK_FALSE(dev.get_control_value_in_scale("dsp", "analog_1_pass_through", "mV", result));
+}
+
+TEST_CASE_FIXTURE(Fixture, "Scale tables must match the size of the range")
+{
+    CHECK(models.loads(R"(
+    {
+        "all_devices": {
+            "Amp": {
+                "audio_sources": [{ "id": "in" }],
+                "audio_sinks": [{ "id": "out" }],
+                "elements": [
+                    {
+                        "id": "dsp",
+                        "element": {
+                            "controls": {
+                                "level": {
+                                    "type": "range", "value_type": "y",
+                                    "min": 0, "max": 3, "step": 1, "scale": "steps",
+                                    "mapped_to_scales": { "mV": { "table": [1, 2, 3] } }
+                                }
+                            }
+                        }
+                    }
+                ],
+                "audio_signal_paths": [
+                    { "connections": { "in": "dsp", "dsp": "out" } }
+                ]
+            }
+        }
+    })"));
+
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+        "Table for scale \"mV\" has 3 entries, but control \"level\" has 4 values",
+        false);
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+        "Table for scale \"mV\" has 3 entries, but control \"level\" has 4 values",
+        false);
+    CHECK(model_cache.get_device_model("Amp") == nullptr);
+    mock_messages->done();
+}
+
+TEST_CASE_FIXTURE(Fixture, "Signal types arriving at sinks are determined from the model")
+{
+    if(!models.load("test_models.json", true))
+        models.load("tests/test_models.json");
+
+    const auto input = R"(
+        {
+            "audio_path_changes": [
+                { "op": "add_instance", "name": "self", "id": "CalaCDR" },
+                {
+                    "op": "set", "element": "self.input_select",
+                    "kv": { "sel": { "type": "s", "value": "d1" } }
+                },
+                {
+                    "op": "set", "element": "self.analog_or_digital",
+                    "kv": { "is_digital": { "type": "b", "value": true } }
+                }
+            ]
+        })";
+    settings.update(input);
+
+    const ConfigStore::SettingsIterator si(settings);
+    const auto dev(si.with_device("self"));
+    CHECK(dev.get_signal_types("digital_out") == std::vector<std::string>({"pcm"}));
+    CHECK(dev.get_signal_types("analog_line_out") ==
+          std::vector<std::string>({"analog_low_power"}));
+    CHECK(dev.get_signal_types("dsp").empty());
+
+    settings.update(R"(
+        {
+            "audio_path_changes": [
+                {
+                    "op": "set", "element": "self.analog_or_digital",
+                    "kv": { "is_digital": { "type": "b", "value": false } }
+                }
+            ]
+        })");
+    CHECK(dev.get_signal_types("digital_out").empty());
+    CHECK(dev.get_signal_types("analog_line_out") ==
+          std::vector<std::string>({"analog_low_power"}));
+}
+
+static std::set<std::string>
+get_active_sinks(const ConfigStore::Settings &settings)
+{
+    std::set<std::string> result;
+    ConfigStore::SettingsIterator(settings).with_device("self").for_each_signal_path(
+        [&result] (const auto &path)
+        {
+            result.insert(path.back().first->get_name());
+            return true;
+        });
+    return result;
+}
+
+static void set_enable(ConfigStore::Settings &settings,
+                       const std::string &element, bool enable)
+{
+    settings.update(nlohmann::json(
+        {
+            {
+                "audio_path_changes",
+                {
+                    {
+                        { "op", "set" },
+                        { "element", "self." + element },
+                        { "kv", { { "enable", { { "type", "b" }, { "value", enable } } } } },
+                    }
+                }
+            }
+        }).dump());
+}
+
+TEST_CASE_FIXTURE(Fixture, "Selectors with identical controls switch their own elements")
+{
+    if(!models.load("test_models.json", true))
+        models.load("tests/test_models.json");
+
+    settings.update(R"(
+        {
+            "audio_path_changes": [
+                { "op": "add_instance", "name": "self", "id": "MP200" },
+                {
+                    "op": "set", "element": "self.input_select",
+                    "kv": { "sel": { "type": "s", "value": "bt" } }
+                }
+            ]
+        })");
+
+    const auto *model =
+        ConfigStore::SettingsIterator(settings).with_device("self").get_model();
+    REQUIRE(model != nullptr);
+
+    static const std::array<const std::string, 4> enables
+    {
+        "hp1_out_enable", "hp2_out_enable", "hp3_out_enable", "analog_out_enable",
+    };
+
+    /* the controls are shared between the elements, their handles are not */
+    std::set<uint32_t> handles;
+    for(const auto &e : enables)
+    {
+        const auto handle(model->get_selector_handle(e, "enable"));
+        REQUIRE(handle.is_valid());
+        handles.insert(handle.get());
+    }
+    CHECK(handles.size() == enables.size());
+    CHECK_FALSE(model->get_selector_handle("hp1_out_enable", "sel").is_valid());
+    CHECK_FALSE(model->get_selector_handle("amp", "enable").is_valid());
+
+    static const std::set<std::string> outputs
+    {
+        "headphone_out1", "headphone_out2", "headphone_out3", "analog_line_out",
+    };
+    const auto active_outputs =
+        [this] ()
+        {
+            std::set<std::string> result;
+            const auto sinks(get_active_sinks(settings));
+            std::set_intersection(sinks.begin(), sinks.end(),
+                                  outputs.begin(), outputs.end(),
+                                  std::inserter(result, result.end()));
+            return result;
+        };
+
+    CHECK(active_outputs().empty());
+
+    set_enable(settings, "hp2_out_enable", true);
+    CHECK(active_outputs() == std::set<std::string>{"headphone_out2"});
+
+    set_enable(settings, "analog_out_enable", true);
+    CHECK(active_outputs() == std::set<std::string>{"analog_line_out", "headphone_out2"});
+
+    set_enable(settings, "hp1_out_enable", true);
+    set_enable(settings, "hp2_out_enable", false);
+    CHECK(active_outputs() == std::set<std::string>{"analog_line_out", "headphone_out1"});
+
+    set_enable(settings, "hp3_out_enable", true);
+    set_enable(settings, "analog_out_enable", false);
+    CHECK(active_outputs() == std::set<std::string>{"headphone_out1", "headphone_out3"});
+}
+
+TEST_CASE_FIXTURE(Fixture, "USB connectors are resolved by device path and audio source")
+{
+    if(!models.load("test_models.json", true))
+        models.load("tests/test_models.json");
+
+    settings.update(R"(
+        {
+            "audio_path_changes": [
+                { "op": "add_instance", "name": "self", "id": "CalaCDR" }
+            ]
+        })");
+
+    const auto *model =
+        ConfigStore::SettingsIterator(settings).with_device("self").get_model();
+    REQUIRE(model != nullptr);
+
+    const auto &conns(model->get_usb_connectors());
+    CHECK(conns.size() == 5);
+
+    const auto *conn =
+        conns.lookup_by_device_path("/sys/bus/usb/devices/1-1.3:1.0");
+    REQUIRE(conn != nullptr);
+    CHECK(conn->id_ == "usb1");
+    CHECK(conn->label_ == "USB 1");
+    CHECK(conn->location_ == "rear");
+    CHECK(conn->audio_source_ == "usb_1");
+
+    /* the unconnected internal port shares its path with the second port */
+    conn = conns.lookup_by_device_path("/sys/bus/usb/devices/1-1.4:1.0");
+    REQUIRE(conn != nullptr);
+    CHECK(conn->id_ == "usb2");
+
+    conn = conns.lookup_by_audio_source("usb_wlan");
+    REQUIRE(conn != nullptr);
+    CHECK(conn->device_path_ == "/sys/bus/usb/devices/1-1.2:1.0");
+
+    CHECK(conns.lookup_by_device_path("/sys/bus/usb/devices/2-1:1.0") == nullptr);
+    CHECK(conns.lookup_by_audio_source("usb_front") == nullptr);
+}
+
+TEST_CASE_FIXTURE(Fixture, "USB hotplug events are mapped to connectors")
+{
+    if(!models.load("test_models.json", true))
+        models.load("tests/test_models.json");
+
+    settings.update(R"(
+        {
+            "audio_path_changes": [
+                { "op": "add_instance", "name": "self", "id": "CalaCDR" }
+            ]
+        })");
+
+    std::vector<nlohmann::json> events;
+    USBHotplug::EventProcessor ep(
+        [this]
+        {
+            return ConfigStore::SettingsIterator(settings).with_device("self").get_model();
+        },
+        [&events] (const nlohmann::json &event) { events.push_back(event); });
+
+    std::istringstream in(
+        "# events as written by a udev rule\n"
+        "add /sys/bus/usb/devices/1-1.3:1.0\n"
+        "add /devices/platform/soc/3f980000.usb/usb1/1-1/1-1.4/1-1.4:1.0\n"
+        "add /sys/bus/usb/devices/2-1:1.0\n"
+        "\n"
+        "add /sys/bus/usb/devices/1-1.3:1.0\n"
+        "remove /sys/bus/usb/devices/1-1.3:1.0\n"
+        "remove /sys/bus/usb/devices/1-1.3:1.0\n"
+        "unplug /sys/bus/usb/devices/1-1.4:1.0\n"
+        "add\n");
+
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+        "Invalid USB hotplug action \"unplug\"", false);
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+        "Invalid USB hotplug event \"add\"", false);
+
+    CHECK(ep.process_stream(in) == 3);
+    REQUIRE(events.size() == 3);
+
+    CHECK(events[0]["action"] == "add");
+    CHECK(events[0]["connector"]["id"] == "usb1");
+    CHECK(events[0]["connector"]["audio_source"] == "usb_1");
+    CHECK(events[1]["action"] == "add");
+    CHECK(events[1]["connector"]["id"] == "usb2");
+    CHECK(events[2]["action"] == "remove");
+    CHECK(events[2]["connector"]["id"] == "usb1");
+
+    const auto plugged(ep.json());
+    REQUIRE(plugged.size() == 1);
+    CHECK(plugged[0]["device_path"] == "/sys/bus/usb/devices/1-1.4:1.0");
+}
+
+TEST_CASE_FIXTURE(Fixture, "Malformed USB hotplug requests are rejected")
+{
+    if(!models.load("test_models.json", true))
+        models.load("tests/test_models.json");
+
+    settings.update(R"(
+        {
+            "audio_path_changes": [
+                { "op": "add_instance", "name": "self", "id": "CalaCDR" }
+            ]
+        })");
+
+    std::vector<nlohmann::json> events;
+    USBHotplug::EventProcessor ep(
+        [this]
+        {
+            return ConfigStore::SettingsIterator(settings).with_device("self").get_model();
+        },
+        [&events] (const nlohmann::json &event) { events.push_back(event); });
+
+    CHECK_THROWS_AS(ep.process_json(nlohmann::json::object()),
+                    nlohmann::json::out_of_range);
+    CHECK_THROWS_AS(ep.process_json(R"({"action": "add"})"_json),
+                    nlohmann::json::out_of_range);
+    CHECK_THROWS_AS(ep.process_json(R"({"device_path": "/sys/bus/usb/devices/1-1.3:1.0"})"_json),
+                    nlohmann::json::out_of_range);
+    CHECK_THROWS_AS(ep.process_json(R"({"action": "add", "device_path": 5})"_json),
+                    nlohmann::json::type_error);
+    CHECK_THROWS_AS(ep.process_json(R"({"action": "unplug", "device_path": "/sys/bus/usb/devices/1-1.3:1.0"})"_json),
+                    std::runtime_error);
+    CHECK(events.empty());
+
+    CHECK(ep.process_json(R"({"action": "add", "device_path": "/sys/bus/usb/devices/1-1.3:1.0"})"_json));
+    REQUIRE(events.size() == 1);
+    CHECK(events[0]["connector"]["id"] == "usb1");
+}
+
+TEST_CASE_FIXTURE(Fixture, "Phases of building a model are reported")
+{
+    if(!models.load("test_models.json", true))
+        models.load("tests/test_models.json");
+
+    std::vector<std::string> phases;
+    const auto model(StaticModels::DeviceModel::mk_model(
+        "CalaCDR", models.get_device_model_definition("CalaCDR"),
+        [&phases] (const char *phase) { phases.emplace_back(phase); }));
+
+    const std::vector<std::string> expected_phases
+    {
+        "parse_elements", "get_io_mappings_from_model", "add_elements",
+        "add_explicit_connections", "add_parent_connections",
+        "add_signal_types", "parse_usb_connectors", "ApplianceBuilder::build",
+    };
+    CHECK(phases == expected_phases);
+
+    const auto &graph(model.get_signal_path_graph());
+    CHECK(graph.get_number_of_elements() == 24);
+    CHECK(graph.get_number_of_edges() == 20);
+}
+
+TEST_CASE_FIXTURE(Fixture, "Compiled device models are used until the source changes")
+{
+    static const std::string source_file("test_compiled_models.json");
+    static const std::string compiled_file("test_compiled_models.bin");
+    const std::string compiling_message(
+        "Compiling models from \"" + source_file + "\" to \"" + compiled_file + "\"");
+
+    std::remove(compiled_file.c_str());
+    std::ofstream(source_file) <<
+        R"({ "all_devices": { "A": { "x": 1 }, "B": { "copy_properties": { "x": "A" } } } })";
+
+    expect<MockMessages::MsgInfo>(mock_messages, compiling_message.c_str(), false);
+    REQUIRE(models.load_compiled(source_file, compiled_file));
+    CHECK(models.get_device_model_definition("B") == R"({ "x": 1 })"_json);
+    mock_messages->done();
+
+    /* unchanged source, compiled file is used */
+    StaticModels::DeviceModelsDatabase from_compiled;
+    REQUIRE(from_compiled.load_compiled(source_file, compiled_file));
+    CHECK(from_compiled.get_device_model_definition("B") == R"({ "x": 1 })"_json);
+    CHECK(from_compiled.get_device_model_definition("A") == R"({ "x": 1 })"_json);
+    CHECK(from_compiled.get_device_model_definition("C").is_null());
+    mock_messages->done();
+
+    /* changed source, compiled file is rewritten */
+    std::ofstream(source_file) <<
+        R"({ "all_devices": { "A": { "x": 2 }, "B": { "copy_properties": { "x": "A" } } } })";
+
+    expect<MockMessages::MsgInfo>(mock_messages, compiling_message.c_str(), false);
+    StaticModels::DeviceModelsDatabase recompiled;
+    REQUIRE(recompiled.load_compiled(source_file, compiled_file));
+    CHECK(recompiled.get_device_model_definition("B") == R"({ "x": 2 })"_json);
+    mock_messages->done();
+
+    StaticModels::DeviceModelsDatabase from_recompiled;
+    REQUIRE(from_recompiled.load_compiled(source_file, compiled_file));
+    CHECK(from_recompiled.get_device_model_definition("B") == R"({ "x": 2 })"_json);
+
+    std::remove(source_file.c_str());
+    std::remove(compiled_file.c_str());
+}
+
+static uint32_t read_compiled_version(const std::string &compiled_file)
+{
+    /* the version follows the 8 bytes magic */
+    uint32_t version = 0;
+    std::ifstream in(compiled_file, std::ios::binary);
+    in.seekg(8);
+    in.read(reinterpret_cast<char *>(&version), sizeof(version));
+    return version;
+}
+
+TEST_CASE_FIXTURE(Fixture, "Compiled device models of other versions are rebuilt")
+{
+    static const std::string source_file("test_compiled_models_version.json");
+    static const std::string compiled_file("test_compiled_models_version.bin");
+    const std::string compiling_message(
+        "Compiling models from \"" + source_file + "\" to \"" + compiled_file + "\"");
+
+    std::remove(compiled_file.c_str());
+    std::ofstream(source_file) <<
+        R"({ "all_devices": { "A": { "x": 1 }, "B": { "copy_properties": { "x": "A" } } } })";
+
+    expect<MockMessages::MsgInfo>(mock_messages, compiling_message.c_str(), false);
+    REQUIRE(models.load_compiled(source_file, compiled_file));
+    mock_messages->done();
+    CHECK(read_compiled_version(compiled_file) == 2);
+
+    /* files written before predefined elements were expanded are version 1 */
+    {
+        const uint32_t old_version = 1;
+        std::fstream f(compiled_file, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(8);
+        f.write(reinterpret_cast<const char *>(&old_version), sizeof(old_version));
+    }
+    REQUIRE(read_compiled_version(compiled_file) == 1);
+
+    expect<MockMessages::MsgInfo>(mock_messages, compiling_message.c_str(), false);
+    StaticModels::DeviceModelsDatabase recompiled;
+    REQUIRE(recompiled.load_compiled(source_file, compiled_file));
+    CHECK(recompiled.get_device_model_definition("B") == R"({ "x": 1 })"_json);
+    mock_messages->done();
+    CHECK(read_compiled_version(compiled_file) == 2);
+
+    std::remove(source_file.c_str());
+    std::remove(compiled_file.c_str());
+}
+
+static std::string mk_simple_model(unsigned int volume_max)
+{
+    return std::string(R"(
+        {
+            "audio_sources": [{ "id": "bluetooth" }],
+            "audio_sinks": [{ "id": "analog_line_out" }],
+            "elements": [
+                {
+                    "id": "dsp",
+                    "element": {
+                        "controls": {
+                            "volume": {
+                                "type": "range", "value_type": "y",
+                                "min": 0, "step": 1, "scale": "steps", "max": )") +
+        std::to_string(volume_max) + R"(
+                            }
+                        }
+                    }
+                }
+            ],
+            "audio_signal_paths": [
+                { "connections": { "bluetooth": "dsp", "dsp": "analog_line_out" } }
+            ]
+        })";
+}
+
+TEST_CASE_FIXTURE(Fixture, "All device models can be built in advance")
+{
+    CHECK(models.loads(std::string(R"({ "all_devices": { "First": )") +
+                       mk_simple_model(99) +
+                       R"(, "Second": )" + mk_simple_model(50) +
+                       R"(, "Third": )" + mk_simple_model(20) + "}}"));
+
+    expect<MockMessages::MsgInfo>(mock_messages, "Built model \"%s\" in %lld us", true);
+    expect<MockMessages::MsgInfo>(mock_messages, "Built model \"%s\" in %lld us", true);
+    expect<MockMessages::MsgInfo>(mock_messages, "Built model \"%s\" in %lld us", true);
+    CHECK(model_cache.prebuild(2) == 3);
+    CHECK(model_cache.size() == 3);
+    mock_messages->done();
+
+    /* already built, so no log messages here */
+    CHECK(model_cache.prebuild(2) == 0);
+    REQUIRE(model_cache.get_device_model("Second") != nullptr);
+    CHECK(model_cache.get_device_model("Second")->name_ == "Second");
+}
+
+TEST_CASE_FIXTURE(Fixture, "Models with identical definitions are built only once")
+{
+    CHECK(models.loads(std::string(R"({ "all_devices": { "First": )") +
+                       mk_simple_model(99) +
+                       R"(, "Second": )" + mk_simple_model(50) +
+                       R"(, "Third": )" + mk_simple_model(99) +
+                       R"(, "Fourth": { "copy_properties": { "all": "First" } })" +
+                       "}}"));
+    models.flatten();
+
+    expect<MockMessages::MsgInfo>(mock_messages, "Built model \"%s\" in %lld us", true);
+    expect<MockMessages::MsgInfo>(mock_messages, "Built model \"%s\" in %lld us", true);
+    CHECK(model_cache.prebuild(2) == 4);
+    mock_messages->done();
+
+    const auto *first = model_cache.get_device_model("First");
+    const auto *second = model_cache.get_device_model("Second");
+    const auto *third = model_cache.get_device_model("Third");
+    const auto *fourth = model_cache.get_device_model("Fourth");
+    REQUIRE(first != nullptr);
+    REQUIRE(second != nullptr);
+    REQUIRE(third != nullptr);
+    REQUIRE(fourth != nullptr);
+
+    CHECK(third->name_ == "Third");
+    CHECK(fourth->name_ == "Fourth");
+    CHECK(third->shares_parts_with(*first));
+    CHECK(fourth->shares_parts_with(*first));
+    CHECK_FALSE(second->shares_parts_with(*first));
+    CHECK(&fourth->get_signal_path_graph() == &first->get_signal_path_graph());
+    CHECK(model_cache.size() == 4);
+    CHECK(model_cache.get_number_of_distinct_models() == 2);
+}
+
+TEST_CASE_FIXTURE(Fixture, "Identical models are found after dropping changed models")
+{
+    CHECK(models.loads(std::string(R"({ "all_devices": { "First": )") +
+                       mk_simple_model(99) +
+                       R"(, "Second": )" + mk_simple_model(99) + "}}"));
+    models.flatten();
+
+    const auto *first = model_cache.get_device_model("First");
+    const auto *second = model_cache.get_device_model("Second");
+    REQUIRE(first != nullptr);
+    REQUIRE(second != nullptr);
+    CHECK(second->shares_parts_with(*first));
+
+    /* the model first built from the shared definition is dropped */
+    CHECK(models.loads(std::string(R"({ "all_devices": { "First": )") +
+                       mk_simple_model(50) +
+                       R"(, "Second": )" + mk_simple_model(99) +
+                       R"(, "Third": )" + mk_simple_model(99) + "}}"));
+    models.flatten();
+    CHECK(model_cache.sync_with_database() == 1);
+    CHECK(model_cache.get_number_of_distinct_models() == 1);
+
+    const auto *third = model_cache.get_device_model("Third");
+    REQUIRE(third != nullptr);
+    CHECK(third->shares_parts_with(*second));
+}
+
+TEST_CASE_FIXTURE(Fixture, "Identical models are shared when built on demand")
+{
+    CHECK(models.loads(std::string(R"({ "all_devices": { "CDR": )") +
+                       mk_simple_model(99) +
+                       R"(, "SR": { "copy_properties": { "all": "CDR" } })" +
+                       "}}"));
+    models.flatten();
+
+    const auto *cdr = model_cache.get_device_model("CDR");
+    const auto *sr = model_cache.get_device_model("SR");
+    REQUIRE(cdr != nullptr);
+    REQUIRE(sr != nullptr);
+    CHECK(sr != cdr);
+    CHECK(sr->name_ == "SR");
+    CHECK(sr->shares_parts_with(*cdr));
+    CHECK(sr->lookup_internal_element("dsp") == cdr->lookup_internal_element("dsp"));
+}
+
+TEST_CASE_FIXTURE(Fixture, "Model definitions can be released after building the models")
+{
+    CHECK(models.loads(R"(
+        {
+            "all_devices": {
+                "Device": {
+                    "audio_sources": [{ "id": "bluetooth" }],
+                    "audio_sinks": [
+                        { "id": "out", "roon": { "rank": 3, "method": "analog" } }
+                    ],
+                    "elements": [
+                        {
+                            "id": "dsp",
+                            "element": {
+                                "controls": {
+                                    "mute": {
+                                        "type": "on_off",
+                                        "roon": { "rank": 7, "template": { "type": "mute" } }
+                                    }
+                                }
+                            }
+                        }
+                    ],
+                    "audio_signal_paths": [
+                        { "connections": { "bluetooth": "dsp", "dsp": "out" } }
+                    ]
+                }
+            }
+        })"));
+
+    StaticModels::DeviceModelCache releasing_cache(models, true);
+    const auto definition_hash(models.get_definition_hash("Device"));
+
+    const auto *dm = releasing_cache.get_device_model("Device");
+    REQUIRE(dm != nullptr);
+    CHECK(models.get_device_model_definition("Device").is_null());
+    CHECK(models.get_definition_hash("Device") == definition_hash);
+    CHECK(releasing_cache.sync_with_database() == 0);
+    CHECK(releasing_cache.get_device_model("Device") == dm);
+
+    /* everything needed later on has been extracted from the definition */
+    const auto *sink = dm->get_audio_sink("out");
+    REQUIRE(sink != nullptr);
+    CHECK(sink->roon_.is_defined_);
+    CHECK(sink->roon_.rank_ == 3);
+    CHECK(sink->roon_.method_ == "analog");
+
+    const auto *elem = dm->lookup_internal_element("dsp");
+    REQUIRE(elem != nullptr);
+    const auto &mute(elem->get_control("mute"));
+    CHECK(mute.roon_.is_defined_);
+    CHECK(mute.roon_.rank_ == 7);
+    CHECK(mute.roon_.conversion_ == R"({ "template": { "type": "mute" } })"_json);
+}
+
+static std::string mk_selector_model(const char *choices)
+{
+    return std::string(R"(
+        {
+            "all_devices": {
+                "Player": {
+                    "audio_sources": [{ "id": "bluetooth" }, { "id": "radio" }],
+                    "audio_sinks": [{ "id": "out" }],
+                    "elements": [
+                        {
+                            "id": "input_select",
+                            "element": {
+                                "stereo_inputs": 2,
+                                "controls": {
+                                    "src": { "type": "choice", "choices": )") +
+        choices + R"( }
+                                }
+                            }
+                        }
+                    ],
+                    "audio_signal_paths": [
+                        {
+                            "connections": {
+                                "bluetooth": "input_select.in0",
+                                "radio": "input_select.in1",
+                                "input_select": "out"
+                            }
+                        },
+                        { "io_mapping": { "select": "input_select@src", "mapping": "mux" } }
+                    ]
+                }
+            }
+        })";
+}
+
+static std::vector<std::string> get_active_sources(const ConfigStore::Settings &settings)
+{
+    std::vector<std::string> result;
+    ConfigStore::SettingsIterator(settings).with_device("self").for_each_signal_path(
+        [&result] (const auto &path)
+        {
+            result.push_back(path.front().first->get_name());
+            return true;
+        });
+    return result;
+}
+
+TEST_CASE_FIXTURE(Fixture, "Models can be replaced while instances are using them")
+{
+    CHECK(models.loads(mk_selector_model(R"([ "bt", "radio" ])")));
+    settings.update(R"(
+        {
+            "audio_path_changes": [
+                { "op": "add_instance", "name": "self", "id": "Player" },
+                {
+                    "op": "set", "element": "self.input_select",
+                    "kv": { "src": { "type": "s", "value": "radio" } }
+                }
+            ]
+        })");
+
+    ConfigStore::Changes changes;
+    ConfigStore::SettingsJSON js(settings);
+    CHECK(js.extract_changes(changes));
+
+    const auto *old_model = model_cache.get_device_model("Player");
+    REQUIRE(old_model != nullptr);
+    CHECK(get_active_sources(settings) == std::vector<std::string>{"radio"});
+
+    StaticModels::DeviceModelCache::Reload reload;
+    CHECK(reload.database_.loads(mk_selector_model(R"([ "radio", "bt" ])")));
+
+    expect<MockMessages::MsgInfo>(mock_messages, "Rebuilt model \"%s\"", true);
+    CHECK(StaticModels::DeviceModelCache::rebuild_changed(
+                reload, model_cache.get_definition_hashes()) == 1);
+    mock_messages->done();
+
+    auto replaced(model_cache.swap_in(std::move(reload)));
+    REQUIRE(replaced.size() == 1);
+    CHECK(replaced[0].get() == old_model);
+
+    CHECK(settings.reattach_models());
+    CHECK_FALSE(settings.reattach_models());
+
+    const auto *new_model = model_cache.get_device_model("Player");
+    REQUIRE(new_model != nullptr);
+    CHECK(new_model != old_model);
+
+    const ConfigStore::SettingsIterator si(settings);
+    CHECK(si.with_device("self").get_model() == new_model);
+
+    const auto *value = si.with_device("self").get_control_value("input_select", "src");
+    REQUIRE(value != nullptr);
+    CHECK(value->get_choice_index() == 0);
+    CHECK(value->get_string() == "radio");
+
+    /* "radio" now maps to the first input, which is connected to bluetooth */
+    replaced.clear();
+    CHECK(get_active_sources(settings) == std::vector<std::string>{"bluetooth"});
+}
+
+/* records what plugins get to see in each report */
+class ReportRecorder: public ClientPlugin::Plugin
+{
+  public:
+    struct Report
+    {
+        const StaticModels::DeviceModel *model_;
+        std::vector<std::pair<std::string, std::string>> values_;
+    };
+
+    std::vector<Report> &reports_;
+
+    explicit ReportRecorder(std::vector<Report> &reports):
+        Plugin("Recorder"),
+        reports_(reports)
+    {}
+
+    void registered() final override {}
+    void unregistered() final override {}
+
+    void report_changes(const ConfigStore::Settings &settings,
+                        const ConfigStore::Changes &changes) const final override
+    {
+        Report r;
+        r.model_ = ConfigStore::SettingsIterator(settings).with_device("self").get_model();
+        changes.for_each_changed_value(
+            [&r] (const auto &name, const auto &old_value, const auto &new_value)
+            { r.values_.emplace_back(name, new_value.get_string()); });
+        reports_.push_back(std::move(r));
+    }
+
+    bool full_report(const ConfigStore::Settings &settings, std::string &report,
+                     std::vector<std::string> &extra) const final override
+    {
+        return false;
+    }
+};
+
+TEST_CASE_FIXTURE(Fixture, "Pending changes are reported before models are reloaded")
+{
+    CHECK(models.loads(mk_selector_model(R"([ "bt", "radio" ])")));
+    settings.update(R"(
+        {
+            "audio_path_changes": [
+                { "op": "add_instance", "name": "self", "id": "Player" },
+                {
+                    "op": "set", "element": "self.input_select",
+                    "kv": { "src": { "type": "s", "value": "radio" } }
+                }
+            ]
+        })");
+
+    const auto *old_model = model_cache.get_device_model("Player");
+    REQUIRE(old_model != nullptr);
+
+    std::vector<ReportRecorder::Report> reports;
+    ClientPlugin::PluginManager pm;
+    auto recorder(std::make_unique<ReportRecorder>(reports));
+    recorder->add_client();
+    pm.register_plugin(std::move(recorder));
+
+    StaticModels::DeviceModelCache::Reload reload;
+    CHECK(reload.database_.loads(mk_selector_model(R"([ "radio", "bt" ])")));
+
+    expect<MockMessages::MsgInfo>(mock_messages, "Rebuilt model \"%s\"", true);
+    CHECK(StaticModels::DeviceModelCache::rebuild_changed(
+                reload, model_cache.get_definition_hashes()) == 1);
+    mock_messages->done();
+
+    expect<MockMessages::MsgInfo>(mock_messages,
+        "Reloaded device models, %zu rebuilt, %zu replaced", true);
+    CHECK(ModelsReload::apply(model_cache, settings, pm, std::move(reload)) == 1);
+
+    const auto *new_model = model_cache.get_device_model("Player");
+    REQUIRE(new_model != nullptr);
+    CHECK(new_model != old_model);
+
+    /* pending change read from the old model, then the switch to the new */
+    REQUIRE(reports.size() == 2);
+    CHECK(reports[0].model_ == old_model);
+    REQUIRE(reports[0].values_.size() == 1);
+    CHECK(reports[0].values_[0].first == "self.input_select.src");
+    CHECK(reports[0].values_[0].second == "radio");
+    CHECK(reports[1].model_ == new_model);
+    CHECK(reports[1].values_.empty());
+
+    CHECK(get_active_sources(settings) == std::vector<std::string>{"bluetooth"});
+}
+
+TEST_CASE_FIXTURE(Fixture, "Current models are kept if reloading the models file fails")
+{
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_ERR,
+        "Failed reading models configuration file \"%s\"", true);
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_ERR,
+        "Keeping current device models", false);
+    CHECK(ModelsReload::load_changed("does_not_exist.json", nullptr,
+                                     model_cache.get_definition_hashes()) == nullptr);
+}
+
+TEST_CASE("Values are converted from and to JSON only at the boundaries")
+{
+    const ConfigStore::Value short_string("s", nlohmann::json("bezier"));
+    const ConfigStore::Value long_string("s", nlohmann::json("a string too long to be inlined"));
+    const ConfigStore::Value level("Y", nlohmann::json(-3));
+    const ConfigStore::Value gain("D", nlohmann::json(-0.75));
+    const ConfigStore::Value flag("b", nlohmann::json(true));
+
+    CHECK(short_string.get_string() == "bezier");
+    CHECK(long_string.get_string() == "a string too long to be inlined");
+    CHECK(level.get_int64() == -3);
+    CHECK(level.get_double() == -3.0);
+    CHECK(gain.get_double() == -0.75);
+    CHECK(flag.get_bool());
+
+    CHECK(short_string.get_value() == "bezier");
+    CHECK(long_string.get_value() == "a string too long to be inlined");
+    CHECK(level.get_value() == -3);
+    CHECK(gain.get_value() == -0.75);
+    CHECK(flag.get_value() == true);
+
+    CHECK_THROWS(level.get_string());
+    CHECK_THROWS(short_string.get_bool());
+    CHECK_THROWS(flag.get_int64());
+    CHECK_THROWS(ConfigStore::Value("Y", nlohmann::json(128)));
+
+    ConfigStore::Value copy(long_string);
+    CHECK(copy == long_string);
+    ConfigStore::Value moved(std::move(copy));
+    CHECK(moved == long_string);
+    CHECK(copy.is_of_type(ConfigStore::ValueType::VT_VOID));
+
+    CHECK(ConfigStore::Value::mk_string("bezier") == short_string);
+    CHECK(ConfigStore::Value::mk_signed(ConfigStore::ValueType::VT_INT8, -3) == level);
+    CHECK(ConfigStore::Value::mk_bool(true) == flag);
+    CHECK(ConfigStore::Value::mk_signed(ConfigStore::ValueType::VT_INT8, -4) < level);
+    CHECK_FALSE(level == ConfigStore::Value("i", nlohmann::json(-3)));
+    CHECK_THROWS(ConfigStore::Value::mk_signed(ConfigStore::ValueType::VT_UINT8, -1));
+}
+
+TEST_CASE("Fixed-point values are stored in native representation")
+{
+    const ConfigStore::Value gain("D", nlohmann::json(-0.75));
+    CHECK(gain.get_fix_point_native() == -12);
+    CHECK(gain == ConfigStore::Value::mk_fix_point(-12));
+    CHECK(gain.get_value() == -0.75);
+
+    /* not representable, rounded to nearest 1/16 */
+    const ConfigStore::Value inexact("D", nlohmann::json(0.1));
+    CHECK(inexact.get_fix_point_native() == 2);
+    CHECK(inexact.get_value() == 0.125);
+    CHECK(inexact == ConfigStore::Value("D", nlohmann::json(0.125)));
+
+    CHECK(ConfigStore::Value("D", nlohmann::json(4)).get_value().is_number_integer());
+    CHECK(ConfigStore::Value::mk_fix_point(-13) < gain);
+    CHECK(ConfigStore::Value("Y", nlohmann::json(-3)).get_fix_point_native() == -48);
+
+    CHECK_THROWS(ConfigStore::Value("D", nlohmann::json(512.0)));
+    CHECK_THROWS(ConfigStore::Value::mk_fix_point(512 * 16));
+}
+
 TEST_SUITE_END();
@@ -110,6 +110,7 @@ class Fixture
   protected:
     ClientPlugin::PluginManager pm;
     StaticModels::DeviceModelsDatabase models;
+    StaticModels::DeviceModelCache model_cache;
     ConfigStore::Settings settings;
     std::unique_ptr<MockMessages::Mock> mock_messages;
 
@@ -118,7 +119,8 @@ class Fixture
 
   public:
     explicit Fixture():
-        settings(models),
+        model_cache(models),
+        settings(model_cache),
         mock_messages(std::make_unique<MockMessages::Mock>()),
         roon_plugin(nullptr)
     {
@@ -689,6 +691,7 @@ class CustomModels
   protected:
     ClientPlugin::PluginManager pm;
     StaticModels::DeviceModelsDatabase models;
+    StaticModels::DeviceModelCache model_cache;
     ConfigStore::Settings settings;
     std::unique_ptr<MockMessages::Mock> mock_messages;
 
@@ -696,7 +699,8 @@ class CustomModels
     RoonUpdate roon_update;
 
     explicit CustomModels():
-        settings(models),
+        model_cache(models),
+        settings(model_cache),
         mock_messages(std::make_unique<MockMessages::Mock>()),
         roon_plugin(nullptr)
     {
@@ -933,6 +937,83 @@ TEST_CASE_FIXTURE(CustomModels, "Settings for linear model with NOP elements")
     pm.report_changes(settings, changes);
 }
 
+TEST_CASE_FIXTURE(CustomModels, "Fixed-point range is mapped to Roon range")
+{
+    const auto model_definition = R"(
+        {
+          "all_devices": {
+            "MyDevice": {
+              "audio_sources": [{ "id": "bluetooth" }],
+              "audio_sinks": [
+                {
+                  "id": "analog_line_out",
+                  "roon": { "rank": 0, "method": "analog" }
+                }
+              ],
+              "elements": [
+                {
+                  "id": "dsp",
+                  "element": {
+                    "controls": {
+                      "balance": {
+                        "type": "range", "value_type": "D",
+                        "min": -8.0, "max": 8.0, "step": 0.0625, "scale": "dB",
+                        "neutral_setting": 0.0,
+                        "roon": {
+                          "rank": 0,
+                          "template": { "type": "balance", "quality": "lossless" },
+                          "value_name": "value",
+                          "value_mapping": {
+                            "type": "to_range", "value_type": "d",
+                            "from": -1.0, "to": 1.0
+                          }
+                        }
+                      }
+                    }
+                  }
+                }
+              ],
+              "audio_signal_paths": [
+                {
+                  "connections": {
+                    "bluetooth": "dsp",
+                    "dsp": "analog_line_out"
+                  }
+                }
+              ]
+            }
+          }
+        })";
+
+    CHECK(models.loads(model_definition));
+
+    const auto input = R"(
+        {
+          "audio_path_changes": [
+            { "op": "add_instance", "name": "self", "id": "MyDevice" },
+            {
+              "op": "set", "element": "self.dsp",
+              "kv": { "balance": { "type": "D", "value": -2.5 } }
+            }
+          ]
+        })";
+    settings.update(input);
+
+    ConfigStore::Changes changes;
+    ConfigStore::SettingsJSON js(settings);
+    CHECK(js.extract_changes(changes));
+
+    const auto expected_update = R"(
+        [
+          { "type": "balance", "value": -0.3125,   "quality": "lossless" },
+          { "type": "output",  "method": "analog", "quality": "lossless" }
+        ]
+    )";
+
+    roon_update.expect(expected_update);
+    pm.report_changes(settings, changes);
+}
+
 TEST_CASE_FIXTURE(CustomModels, "Subsequent changes of Roon-related settings")
 {
     const auto model_definition = R"(
@@ -1117,6 +1198,7 @@ class ConnFixture
   protected:
     ClientPlugin::PluginManager pm;
     StaticModels::DeviceModelsDatabase models;
+    StaticModels::DeviceModelCache model_cache;
     ConfigStore::Settings settings;
     std::unique_ptr<MockMessages::Mock> mock_messages;
 
@@ -1125,7 +1207,8 @@ class ConnFixture
 
   public:
     explicit ConnFixture():
-        settings(models),
+        model_cache(models),
+        settings(model_cache),
         mock_messages(std::make_unique<MockMessages::Mock>()),
         roon_plugin(nullptr)
     {
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "sha256.hh"
+
+#include <iomanip>
+#include <sstream>
+
+static std::string to_hex(const Hashing::SHA256Digest &digest)
+{
+    std::ostringstream os;
+
+    for(const auto &b : digest)
+        os << std::hex << std::setw(2) << std::setfill('0') << unsigned(b);
+
+    return os.str();
+}
+
+TEST_SUITE_BEGIN("SHA-256");
+
+/* test vectors from FIPS 180-2, appendix B */
+TEST_CASE("Digest of empty input")
+{
+    CHECK(to_hex(Hashing::sha256("")) ==
+          "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+}
+
+TEST_CASE("Digest of one-block input")
+{
+    CHECK(to_hex(Hashing::sha256("abc")) ==
+          "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+}
+
+TEST_CASE("Digest of multi-block input")
+{
+    CHECK(to_hex(Hashing::sha256(
+            "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")) ==
+          "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    CHECK(to_hex(Hashing::sha256(
+            "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+            "hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu")) ==
+          "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1");
+    CHECK(to_hex(Hashing::sha256(std::string(1000000, 'a'))) ==
+          "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+TEST_CASE("Digest of input with length close to block boundary")
+{
+    /* the length in bits does not fit into the last block from 56 bytes on */
+    CHECK(to_hex(Hashing::sha256(std::string(55, 'x'))) ==
+          "d5e285683cd4efc02d021a5c62014694958901005d6f71e89e0989fac77e4072");
+    CHECK(to_hex(Hashing::sha256(std::string(56, 'x'))) ==
+          "04c26261370ee7541549d16dee320c723e3fd14671e66a099afe0a377c16888e");
+    CHECK(to_hex(Hashing::sha256(std::string(63, 'x'))) ==
+          "75220b47218278e656f2013bb8f0c455a25eaf01e86c64924e9d48d89776d6f2");
+    CHECK(to_hex(Hashing::sha256(std::string(64, 'x'))) ==
+          "7ce100971f64e7001e8fe5a51973ecdfe1ced42befe7ee8d5fd6219506b5393c");
+}
+
+TEST_SUITE_END();
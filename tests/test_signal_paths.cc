@@ -101,6 +101,36 @@ static void expect_audio_paths(
         CHECK(paths[i] == expected[i]);
 }
 
+static void expect_audio_paths_to_sink(
+        const ModelCompliant::SignalPathTracker &tracker,
+        const StaticModels::SignalPaths::PathElement &sink,
+        const std::vector<std::vector<const StaticModels::SignalPaths::PathElement *>> &expected)
+{
+    std::vector<std::vector<const StaticModels::SignalPaths::PathElement *>> paths;
+    CHECK(tracker.enumerate_active_signal_paths_to_sink(
+                sink,
+                [&paths] (const auto &p) { return append_path(paths, p, false); }));
+    REQUIRE(paths.size() == expected.size());
+
+    /* must be the same as the paths found by walking downstream */
+    std::vector<std::vector<const StaticModels::SignalPaths::PathElement *>> all_paths;
+    CHECK(tracker.enumerate_active_signal_paths(
+                [&all_paths, &sink] (const auto &p)
+                {
+                    return p.back().first == &sink
+                        ? append_path(all_paths, p, false)
+                        : true;
+                }));
+
+    auto sorted_expected(expected);
+    std::sort(sorted_expected.begin(), sorted_expected.end());
+    std::sort(paths.begin(), paths.end());
+    std::sort(all_paths.begin(), all_paths.end());
+
+    CHECK(paths == sorted_expected);
+    CHECK(all_paths == sorted_expected);
+}
+
 /*
  *              +------------------+
  *              | input_select     |
@@ -622,4 +652,678 @@ TEST_CASE_FIXTURE(Fixture, "Two outputs connected to the same sink")
             [] (const auto &p) { FAIL("unexpected"); return false; }));
 }
 
+/*
+ *                          +------------------+
+ *                          | input_select     |
+ *                          +------------------+
+ *                          | in | [sel] | out |
+ * spdif (pcm)         ---->| 0  |   0   |   0 |---> digital_out (pcm)
+ * usb (pcm, dsd)      ---->| 1  |   1   |     |---> i2s_out
+ *                          |    |       |     |---> dac (analog) ---> line_out
+ *                          +------------------+
+ */
+TEST_CASE_FIXTURE(Fixture, "Signal types are propagated along active paths")
+{
+    using StaticModels::SignalPaths::Input;
+    using StaticModels::SignalPaths::Output;
+    using StaticModels::SignalPaths::Selector;
+
+    StaticModels::SignalPaths::ApplianceBuilder builder("MyDevice");
+
+    builder.add_element(StaticModels::SignalPaths::StaticElement("spdif"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("usb"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("digital_out"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("i2s_out"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("dac"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("line_out"));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_mux(
+            "input_select", "sel", { Input(0), Input(1) }));
+    builder.no_more_elements();
+
+    const auto pcm = builder.mk_signal_type("pcm");
+    const auto dsd = builder.mk_signal_type("dsd");
+    const auto analog = builder.mk_signal_type("analog");
+    CHECK(builder.mk_signal_type("pcm") == pcm);
+    CHECK(pcm != dsd);
+
+    auto &sel(builder.lookup_element("input_select"));
+    auto &dac(builder.lookup_element("dac"));
+
+    builder.lookup_element("spdif").connect(Output(0), sel, Input(0));
+    builder.lookup_element("usb").connect(Output(0), sel, Input(1));
+    sel.connect(Output(0), builder.lookup_element("digital_out"), Input(0));
+    sel.connect(Output(0), builder.lookup_element("i2s_out"), Input(0));
+    sel.connect(Output(0), dac, Input(0));
+    dac.connect(Output(0), builder.lookup_element("line_out"), Input(0));
+
+    builder.lookup_element("spdif").declare_output_types(pcm);
+    builder.lookup_element("usb").declare_output_types(Output(0), pcm | dsd);
+    builder.lookup_element("digital_out").declare_input_types(pcm);
+    dac.declare_output_types(analog);
+
+    const auto dev(builder.build());
+    const auto &digital_out(*dev.lookup_element("digital_out"));
+    const auto &i2s_out(*dev.lookup_element("i2s_out"));
+    const auto &line_out(*dev.lookup_element("line_out"));
+
+    ModelCompliant::SignalPathTracker tracker(dev);
+    CHECK(tracker.get_signal_types(digital_out) == 0);
+    CHECK(tracker.get_signal_types(i2s_out) == 0);
+    CHECK(tracker.get_signal_types(line_out) == 0);
+
+    CHECK(tracker.select("input_select", Selector(0)));
+    CHECK(tracker.get_signal_types(digital_out) == pcm);
+    CHECK(tracker.get_signal_types(i2s_out) == pcm);
+    CHECK(tracker.get_signal_types(line_out) == analog);
+
+    CHECK(tracker.select("input_select", Selector(1)));
+    CHECK(tracker.get_signal_types(digital_out) == pcm);
+    CHECK(tracker.get_signal_types(i2s_out) == (pcm | dsd));
+    CHECK(tracker.get_signal_types(line_out) == analog);
+    CHECK(dev.to_names(tracker.get_signal_types(i2s_out)) ==
+          std::vector<std::string>({"pcm", "dsd"}));
+
+    tracker.enumerate_active_signal_paths(
+        [&tracker, &i2s_out, pcm, dsd] (const auto &p)
+        {
+            if(p.back().first == &i2s_out)
+                CHECK(tracker.get_signal_types(p) == (pcm | dsd));
+
+            return true;
+        });
+
+    CHECK(tracker.floating("input_select"));
+    CHECK(tracker.get_signal_types(digital_out) == 0);
+    CHECK(tracker.get_signal_types(i2s_out) == 0);
+    CHECK(tracker.get_signal_types(line_out) == 0);
+}
+
+/*
+ *              +------------------+
+ *              | splitter         |
+ *              +------------------+
+ *              | in | [sel] | out |
+ * source ----->| 0  |   0   |   0 |---+---> sink_B
+ *              |    |       |     |   '---> sink_A
+ *              |    |       |   1 |-------> sink_C
+ *              +------------------+
+ */
+TEST_CASE_FIXTURE(Fixture, "Signal path graph is laid out compactly")
+{
+    using StaticModels::SignalPaths::Input;
+    using StaticModels::SignalPaths::Output;
+
+    StaticModels::SignalPaths::ApplianceBuilder builder("MyDevice");
+
+    builder.add_element(StaticModels::SignalPaths::StaticElement("source"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_A"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_B"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_C"));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_table(
+            "splitter", "sel", {{{Input(0), Output(0)}, {Input(0), Output(1)}}}));
+    builder.no_more_elements();
+
+    auto &splitter(builder.lookup_element("splitter"));
+    builder.lookup_element("source").connect(Output(0), splitter, Input(0));
+    splitter.connect(Output(1), builder.lookup_element("sink_C"), Input(0));
+    splitter.connect(Output(0), builder.lookup_element("sink_B"), Input(0));
+    splitter.connect(Output(0), builder.lookup_element("sink_A"), Input(0));
+
+    const auto dev(builder.build());
+    const auto &g(dev.get_graph());
+
+    REQUIRE(g.size() == 5);
+    CHECK(g.get_number_of_edges() == 4);
+    CHECK(dev.get_number_of_edges() == 4);
+
+    /* static elements first, then switching elements, in order of addition */
+    const auto source = dev.lookup_element("source")->get_index();
+    const auto sink_a = dev.lookup_element("sink_A")->get_index();
+    const auto sink_b = dev.lookup_element("sink_B")->get_index();
+    const auto sink_c = dev.lookup_element("sink_C")->get_index();
+    const auto split = dev.lookup_element("splitter")->get_index();
+    CHECK(source == 0);
+    CHECK(split == 4);
+    CHECK(&g.get_element(split) == dev.lookup_element("splitter"));
+
+    CHECK_FALSE(g.is_sink(source));
+    CHECK(g.is_sink(sink_a));
+    CHECK_FALSE(g.is_sink(split));
+
+    /* outputs in pad order, edges in connection order */
+    REQUIRE(g.outputs_end(split) - g.outputs_begin(split) == 2);
+    const auto &out0(g.outputs_begin(split)[0]);
+    const auto &out1(g.outputs_begin(split)[1]);
+    CHECK(out0.pad_ == 0);
+    CHECK(out1.pad_ == 1);
+    CHECK(g.find_output(split, Output(1)) == &out1);
+    CHECK(g.find_output(split, Output(2)) == nullptr);
+
+    REQUIRE(g.edges_end(out0) - g.edges_begin(out0) == 2);
+    CHECK(g.edges_begin(out0)[0].target_ == sink_b);
+    CHECK(g.edges_begin(out0)[1].target_ == sink_a);
+    REQUIRE(g.edges_end(out1) - g.edges_begin(out1) == 1);
+    CHECK(g.edges_begin(out1)[0].target_ == sink_c);
+    CHECK(g.edges_begin(out1)[0].target_pad_ == 0);
+}
+
+TEST_CASE_FIXTURE(Fixture, "Mappings are stored as bit matrices")
+{
+    using StaticModels::SignalPaths::Input;
+    using StaticModels::SignalPaths::Output;
+    using StaticModels::SignalPaths::Selector;
+
+    StaticModels::SignalPaths::ApplianceBuilder builder("MyDevice");
+
+    builder.add_element(StaticModels::SignalPaths::StaticElement("source_A"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("source_B"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_A"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_B"));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_table(
+            "matrix", "sel",
+            {
+                {{Input(0), Output(0)}, {Input(0), Output(2)}, {Input(1), Output(1)}},
+                {{Input(1), Output(0)}, {Input(1), Output(1)}, {Input(1), Output(2)}},
+                {},
+            }));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_mux(
+            "mux", "sel", { Input(1), Input::mk_unconnected(), Input(0) }));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_D"));
+    builder.no_more_elements();
+
+    auto &matrix(builder.lookup_element("matrix"));
+    auto &mux(builder.lookup_element("mux"));
+    builder.lookup_element("source_A").connect(Output(0), matrix, Input(0));
+    builder.lookup_element("source_B").connect(Output(0), matrix, Input(1));
+    matrix.connect(Output(0), builder.lookup_element("sink_A"), Input(0));
+    matrix.connect(Output(1), builder.lookup_element("sink_B"), Input(0));
+    matrix.connect(Output(2), mux, Input(0));
+    builder.lookup_element("source_B").connect(Output(0), mux, Input(1));
+    mux.connect(Output(0), builder.lookup_element("sink_D"), Input(0));
+
+    const auto dev(builder.build());
+
+    const auto &m(dev.lookup_switching_element("matrix")->get_matrix());
+    CHECK(m.outputs_fed_by(Selector(0), Input(0)) == 0b101);
+    CHECK(m.outputs_fed_by(Selector(0), Input(1)) == 0b010);
+    CHECK(m.outputs_fed_by(Selector(1), Input(0)) == 0);
+    CHECK(m.outputs_fed_by(Selector(1), Input(1)) == 0b111);
+    CHECK(m.outputs_fed_by(Selector(2), Input(1)) == 0);
+    CHECK(m.outputs_fed_by(Selector(3), Input(1)) == 0);
+    CHECK(m.outputs_fed_by(Selector(0), Input(2)) == 0);
+    CHECK(m.inputs_feeding(Selector(0), Output(2)) == 0b01);
+    CHECK(m.inputs_feeding(Selector(1), Output(2)) == 0b10);
+    CHECK(m.is_connected(Selector(0), Input(0), Output(2)));
+    CHECK_FALSE(m.is_connected(Selector(0), Input(0), Output(1)));
+    CHECK_FALSE(m.is_connected(Selector(0), Input(0), Output(63)));
+    CHECK_FALSE(m.is_connected(Selector(0), Input::mk_unconnected(), Output(0)));
+
+    const auto &x(dev.lookup_switching_element("mux")->get_matrix());
+    CHECK(x.outputs_fed_by(Selector(0), Input(1)) == 0b1);
+    CHECK(x.outputs_fed_by(Selector(1), Input(0)) == 0);
+    CHECK(x.outputs_fed_by(Selector(1), Input(1)) == 0);
+    CHECK(x.inputs_feeding(Selector(2), Output(0)) == 0b01);
+    CHECK_FALSE(x.is_connected(Selector(2), Input(0), Output::mk_unconnected()));
+}
+
+TEST_CASE_FIXTURE(Fixture, "Mapping connections beyond matrix size are reported")
+{
+    using StaticModels::SignalPaths::Input;
+    using StaticModels::SignalPaths::Output;
+    using StaticModels::SignalPaths::Selector;
+
+    const StaticModels::SignalPaths::MappingTable table(
+        {
+            {{Input(0), Output(1)}, {Input(64), Output(0)}},
+            {{Input(1), Output(70)}},
+        });
+
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_CRIT,
+        "BUG: Mapping pad index too large for matrix "
+        "(%u -> %u for selector value %u) [connection ignored]", true);
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_CRIT,
+        "BUG: Mapping pad index too large for matrix "
+        "(%u -> %u for selector value %u) [connection ignored]", true);
+    const StaticModels::SignalPaths::MappingMatrix m(table);
+
+    CHECK(m.outputs_fed_by(Selector(0), Input(0)) == 0b10);
+    CHECK(m.inputs_feeding(Selector(0), Output(0)) == 0);
+    CHECK(m.outputs_fed_by(Selector(1), Input(1)) == 0);
+}
+
+TEST_CASE_FIXTURE(Fixture, "Active paths for repeated selector states are reused")
+{
+    using StaticModels::SignalPaths::Input;
+    using StaticModels::SignalPaths::Output;
+    using StaticModels::SignalPaths::Selector;
+
+    StaticModels::SignalPaths::ApplianceBuilder builder("MyDevice");
+
+    builder.add_element(StaticModels::SignalPaths::StaticElement("source_A"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("source_B"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_A"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_B"));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_mux(
+            "input_select", "sel", { Input(0), Input(1) }));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_demux(
+            "output_select", "sel", { Output(0), Output(1) }));
+    builder.no_more_elements();
+
+    auto &in(builder.lookup_element("input_select"));
+    auto &out(builder.lookup_element("output_select"));
+    builder.lookup_element("source_A").connect(Output(0), in, Input(0));
+    builder.lookup_element("source_B").connect(Output(0), in, Input(1));
+    in.connect(Output(0), out, Input(0));
+    out.connect(Output(0), builder.lookup_element("sink_A"), Input(0));
+    out.connect(Output(1), builder.lookup_element("sink_B"), Input(0));
+
+    const auto dev(builder.build());
+
+    ModelCompliant::SignalPathTracker tracker(dev);
+
+    /* all selector states, visited twice to hit the cached active paths */
+    for(int round = 0; round < 2; ++round)
+    {
+        for(unsigned int i = 0; i < 4; ++i)
+        {
+            tracker.select("input_select", Selector(i & 1));
+            tracker.select("output_select", Selector(i >> 1));
+            expect_audio_path(tracker,
+                              {
+                                  dev.lookup_element((i & 1) == 0 ? "source_A" : "source_B"),
+                                  dev.lookup_element("input_select"),
+                                  dev.lookup_element("output_select"),
+                                  dev.lookup_element((i >> 1) == 0 ? "sink_A" : "sink_B"),
+                              });
+            expect_audio_path(tracker,
+                              {
+                                  dev.lookup_element((i & 1) == 0 ? "source_A" : "source_B"),
+                                  dev.lookup_element("input_select"),
+                                  dev.lookup_element("output_select"),
+                                  dev.lookup_element((i >> 1) == 0 ? "sink_A" : "sink_B"),
+                              });
+        }
+    }
+
+    CHECK_FALSE(tracker.enumerate_active_signal_paths(
+            [] (const auto &p) { return false; }));
+
+    CHECK(tracker.floating("output_select"));
+    CHECK(tracker.enumerate_active_signal_paths(
+            [] (const auto &p) { FAIL("unexpected"); return false; }));
+
+    CHECK(tracker.select("output_select", Selector(0)));
+    expect_audio_path(tracker,
+                      {
+                          dev.lookup_element("source_B"),
+                          dev.lookup_element("input_select"),
+                          dev.lookup_element("output_select"),
+                          dev.lookup_element("sink_A"),
+                      });
+}
+
+static std::set<const StaticModels::SignalPaths::PathElement *>
+elements_on_active_paths(const ModelCompliant::SignalPathTracker &tracker)
+{
+    std::set<const StaticModels::SignalPaths::PathElement *> result;
+    tracker.enumerate_active_signal_paths(
+        [&result] (const auto &path)
+        {
+            for(const auto &p : path)
+                result.insert(p.first);
+
+            return true;
+        });
+    return result;
+}
+
+static void expect_active_elements(const ModelCompliant::SignalPathTracker &tracker,
+                                   const std::vector<std::string> &names)
+{
+    const auto &dev(tracker.get_appliance());
+    const auto active(elements_on_active_paths(tracker));
+
+    for(const auto &name : names)
+    {
+        const auto *elem = dev.lookup_element(name);
+        REQUIRE(elem != nullptr);
+        CHECK(tracker.is_on_active_path(*elem) == (active.find(elem) != active.end()));
+    }
+}
+
+/*
+ *                        +-------------+     +--------------+
+ *                        | input_sel   |     | output_sel   |
+ * source A --------+---->| 0         0 |---->| 0          0 |---> sink A
+ *                  |     |             |     |            1 |---> sink B
+ *                  |  +->| 1           |     +--------------+
+ * source B --------|--+  +-------------+
+ *                  |     +-------------+     +--------------+
+ *                  +---->| 0  unused 0 |---->| 0   tap    0 |---> sink C
+ *                        +-------------+     +--------------+
+ */
+TEST_CASE_FIXTURE(Fixture, "Selector changes report changes of active paths")
+{
+    using StaticModels::SignalPaths::Input;
+    using StaticModels::SignalPaths::Output;
+    using StaticModels::SignalPaths::Selector;
+
+    StaticModels::SignalPaths::ApplianceBuilder builder("MyDevice");
+
+    builder.add_element(StaticModels::SignalPaths::StaticElement("source_A"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("source_B"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_A"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_B"));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_mux(
+            "input_select", "sel", { Input(0), Input(1) }));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_demux(
+            "output_select", "sel", { Output(0), Output(1) }));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_mux(
+            "unused", "sel", { Input(0), Input::mk_unconnected() }));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_demux(
+            "tap", "sel", { Output(0), Output::mk_unconnected() }));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_C"));
+    builder.no_more_elements();
+
+    auto &in(builder.lookup_element("input_select"));
+    auto &out(builder.lookup_element("output_select"));
+    builder.lookup_element("source_A").connect(Output(0), in, Input(0));
+    builder.lookup_element("source_A").connect(Output(0), builder.lookup_element("unused"), Input(0));
+    builder.lookup_element("source_B").connect(Output(0), in, Input(1));
+    in.connect(Output(0), out, Input(0));
+    out.connect(Output(0), builder.lookup_element("sink_A"), Input(0));
+    out.connect(Output(1), builder.lookup_element("sink_B"), Input(0));
+    builder.lookup_element("unused").connect(Output(0), builder.lookup_element("tap"), Input(0));
+    builder.lookup_element("tap").connect(Output(0), builder.lookup_element("sink_C"), Input(0));
+
+    const auto dev(builder.build());
+
+    ModelCompliant::SignalPathTracker tracker(dev);
+    const std::vector<std::string> all_names
+    {
+        "source_A", "source_B", "sink_A", "sink_B", "sink_C",
+        "input_select", "output_select", "unused", "tap",
+    };
+    bool changed = true;
+
+    expect_active_elements(tracker, all_names);
+
+    /* nothing leads to a sink yet */
+    CHECK(tracker.select("input_select", Selector(0), changed));
+    CHECK_FALSE(changed);
+    expect_active_elements(tracker, all_names);
+
+    CHECK(tracker.select("output_select", Selector(1), changed));
+    CHECK(changed);
+    expect_active_elements(tracker, all_names);
+    CHECK(tracker.is_on_active_path(*dev.lookup_element("source_A")));
+    CHECK(tracker.is_on_active_path(*dev.lookup_element("sink_B")));
+    CHECK_FALSE(tracker.is_on_active_path(*dev.lookup_element("sink_A")));
+
+    /* selecting the same value again is no change at all */
+    changed = true;
+    CHECK_FALSE(tracker.select("output_select", Selector(1), changed));
+    CHECK_FALSE(changed);
+
+    /* the unused mux has no sink downstream while the tap is floating */
+    CHECK(tracker.select("unused", Selector(0), changed));
+    CHECK_FALSE(changed);
+    CHECK_FALSE(tracker.is_on_active_path(*dev.lookup_element("unused")));
+    CHECK(tracker.select("tap", Selector(0), changed));
+    CHECK(changed);
+    expect_active_elements(tracker, all_names);
+    CHECK(tracker.is_on_active_path(*dev.lookup_element("unused")));
+    CHECK(tracker.select("tap", Selector(1), changed));
+    CHECK(changed);
+    CHECK_FALSE(tracker.is_on_active_path(*dev.lookup_element("unused")));
+
+    CHECK(tracker.select("input_select", Selector(1), changed));
+    CHECK(changed);
+    expect_active_elements(tracker, all_names);
+    CHECK(tracker.is_on_active_path(*dev.lookup_element("source_B")));
+    CHECK_FALSE(tracker.is_on_active_path(*dev.lookup_element("source_A")));
+
+    CHECK(tracker.floating("output_select", changed));
+    CHECK(changed);
+    expect_active_elements(tracker, all_names);
+
+    /* nothing leads to a sink anymore */
+    CHECK(tracker.select("input_select", Selector(0), changed));
+    CHECK_FALSE(changed);
+    CHECK(tracker.floating("input_select", changed));
+    CHECK_FALSE(changed);
+    CHECK_FALSE(tracker.floating("input_select", changed));
+    CHECK_FALSE(changed);
+    expect_active_elements(tracker, all_names);
+
+    CHECK(tracker.select("output_select", Selector(0), changed));
+    CHECK_FALSE(changed);
+    CHECK(tracker.select("input_select", Selector(0), changed));
+    CHECK(changed);
+    expect_active_elements(tracker, all_names);
+    expect_audio_path(tracker,
+                      {
+                          dev.lookup_element("source_A"),
+                          dev.lookup_element("input_select"),
+                          dev.lookup_element("output_select"),
+                          dev.lookup_element("sink_A"),
+                      });
+}
+
+TEST_CASE_FIXTURE(Fixture, "Selectors are set through dense handles")
+{
+    using StaticModels::SignalPaths::Input;
+    using StaticModels::SignalPaths::Output;
+    using StaticModels::SignalPaths::Selector;
+    using StaticModels::SignalPaths::SelectorHandle;
+
+    StaticModels::SignalPaths::ApplianceBuilder builder("MyDevice");
+
+    builder.add_element(StaticModels::SignalPaths::StaticElement("source_A"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("source_B"));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_mux(
+            "input_select", "sel", { Input(0), Input(1) }));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_A"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_B"));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_demux(
+            "output_select", "sel", { Output(0), Output(1) }));
+    builder.no_more_elements();
+
+    auto &in(builder.lookup_element("input_select"));
+    auto &out(builder.lookup_element("output_select"));
+    builder.lookup_element("source_A").connect(Output(0), in, Input(0));
+    builder.lookup_element("source_B").connect(Output(0), in, Input(1));
+    in.connect(Output(0), out, Input(0));
+    out.connect(Output(0), builder.lookup_element("sink_A"), Input(0));
+    out.connect(Output(1), builder.lookup_element("sink_B"), Input(0));
+
+    const auto dev(builder.build());
+
+    REQUIRE(dev.get_number_of_switching_elements() == 2);
+
+    const auto in_handle(dev.lookup_selector_handle("input_select"));
+    const auto out_handle(dev.lookup_selector_handle("output_select"));
+    REQUIRE(in_handle.is_valid());
+    REQUIRE(out_handle.is_valid());
+    CHECK(in_handle != out_handle);
+    CHECK(in_handle.get() < 2);
+    CHECK(out_handle.get() < 2);
+    CHECK(dev.lookup_switching_element(in_handle) == dev.lookup_switching_element("input_select"));
+    CHECK(dev.lookup_switching_element(out_handle) == dev.lookup_switching_element("output_select"));
+    CHECK(dev.lookup_switching_element(in_handle)->get_selector_handle() == in_handle);
+    CHECK_FALSE(dev.lookup_selector_handle("source_A").is_valid());
+    CHECK_FALSE(dev.lookup_selector_handle("unknown").is_valid());
+    CHECK(dev.lookup_switching_element(SelectorHandle(2)) == nullptr);
+    CHECK(dev.lookup_switching_element(SelectorHandle::mk_invalid()) == nullptr);
+
+    ModelCompliant::SignalPathTracker tracker(dev);
+
+    CHECK(tracker.select(in_handle, Selector(1)));
+    CHECK_FALSE(tracker.select("input_select", Selector(1)));
+    CHECK(tracker.select(out_handle, Selector(0)));
+    CHECK(tracker.get_selector_value(dev.lookup_switching_element("input_select")) == Selector(1));
+    expect_audio_path(tracker,
+                      {
+                          dev.lookup_element("source_B"),
+                          dev.lookup_element("input_select"),
+                          dev.lookup_element("output_select"),
+                          dev.lookup_element("sink_A"),
+                      });
+
+    CHECK(tracker.floating(in_handle));
+    CHECK_FALSE(tracker.floating("input_select"));
+    CHECK_FALSE(tracker.get_selector_value(dev.lookup_switching_element(in_handle)).is_valid());
+    CHECK(tracker.enumerate_active_signal_paths(
+            [] (const auto &p) { FAIL("unexpected"); return false; }));
+}
+
+TEST_CASE_FIXTURE(Fixture, "Path elements are told apart by their kind")
+{
+    using StaticModels::SignalPaths::Input;
+    using StaticModels::SignalPaths::Output;
+    using StaticModels::SignalPaths::PathElement;
+
+    StaticModels::SignalPaths::ApplianceBuilder builder("MyDevice");
+
+    builder.add_element(StaticModels::SignalPaths::StaticElement("source"));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_mux(
+            "mux", "sel", { Input(0), Input::mk_unconnected() }));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink"));
+    builder.no_more_elements();
+
+    auto &mux(builder.lookup_element("mux"));
+    builder.lookup_element("source").connect(Output(0), mux, Input(0));
+    mux.connect(Output(0), builder.lookup_element("sink"), Input(0));
+
+    const auto dev(builder.build());
+
+    const auto *source = dev.lookup_element("source");
+    const auto *sw = dev.lookup_element("mux");
+    REQUIRE(source != nullptr);
+    REQUIRE(sw != nullptr);
+
+    CHECK(source->get_kind() == PathElement::Kind::STATIC);
+    CHECK(sw->get_kind() == PathElement::Kind::SWITCHING);
+    CHECK(source->as_switching_element() == nullptr);
+    CHECK(sw->as_switching_element() == sw);
+    CHECK(dev.lookup_switching_element("mux") == sw);
+    CHECK(dev.lookup_switching_element("source") == nullptr);
+    CHECK(dev.lookup_switching_element("unknown") == nullptr);
+}
+
+TEST_CASE_FIXTURE(Fixture, "Active paths to a sink are found by walking upstream")
+{
+    using StaticModels::SignalPaths::Input;
+    using StaticModels::SignalPaths::Output;
+    using StaticModels::SignalPaths::Selector;
+
+    StaticModels::SignalPaths::ApplianceBuilder builder("MyDevice");
+
+    builder.add_element(StaticModels::SignalPaths::StaticElement("source_A"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("source_B"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("source_C"));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_mux(
+            "input_select", "sel", { Input(0), Input(1) }));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("mixer"));
+    builder.add_element(StaticModels::SignalPaths::SwitchingElement::mk_demux(
+            "output_select", "sel", { Output(0), Output(1) }));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_A"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_B"));
+    builder.add_element(StaticModels::SignalPaths::StaticElement("sink_C"));
+    builder.no_more_elements();
+
+    auto &in(builder.lookup_element("input_select"));
+    auto &mixer(builder.lookup_element("mixer"));
+    auto &out(builder.lookup_element("output_select"));
+    builder.lookup_element("source_A").connect(Output(0), in, Input(0));
+    builder.lookup_element("source_B").connect(Output(0), in, Input(1));
+    builder.lookup_element("source_C").connect(Output(0), mixer, Input(1));
+    in.connect(Output(0), mixer, Input(0));
+    mixer.connect(Output(0), builder.lookup_element("sink_A"), Input(0));
+    mixer.connect(Output(0), out, Input(0));
+    out.connect(Output(0), builder.lookup_element("sink_B"), Input(0));
+    out.connect(Output(1), builder.lookup_element("sink_C"), Input(0));
+
+    const auto dev(builder.build());
+
+    const auto *source_A = dev.lookup_element("source_A");
+    const auto *source_B = dev.lookup_element("source_B");
+    const auto *source_C = dev.lookup_element("source_C");
+    const auto *in_sel = dev.lookup_element("input_select");
+    const auto *mix = dev.lookup_element("mixer");
+    const auto *out_sel = dev.lookup_element("output_select");
+    const auto *sink_A = dev.lookup_element("sink_A");
+    const auto *sink_B = dev.lookup_element("sink_B");
+    const auto *sink_C = dev.lookup_element("sink_C");
+
+    ModelCompliant::SignalPathTracker tracker(dev);
+
+    /* only the source connected directly to the mixer is audible */
+    expect_audio_paths_to_sink(tracker, *sink_A, {{ source_C, mix, sink_A }});
+    expect_audio_paths_to_sink(tracker, *sink_B, {});
+
+    tracker.select("input_select", Selector(1));
+    tracker.select("output_select", Selector(0));
+
+    expect_audio_paths_to_sink(tracker, *sink_A,
+                               {
+                                   { source_B, in_sel, mix, sink_A },
+                                   { source_C, mix, sink_A },
+                               });
+    expect_audio_paths_to_sink(tracker, *sink_B,
+                               {
+                                   { source_B, in_sel, mix, out_sel, sink_B },
+                                   { source_C, mix, out_sel, sink_B },
+                               });
+    expect_audio_paths_to_sink(tracker, *sink_C, {});
+
+    /* elements which are not sinks have no paths ending in them */
+    expect_audio_paths_to_sink(tracker, *mix, {});
+    expect_audio_paths_to_sink(tracker, *out_sel, {});
+
+    /* the elements shared with the previous path are marked, including the
+     * output selector and the sink */
+    std::vector<std::vector<bool>> marks;
+    CHECK(tracker.enumerate_active_signal_paths_to_sink(
+            *sink_B,
+            [&marks] (const auto &path)
+            {
+                marks.emplace_back();
+                std::transform(path.begin(), path.end(), std::back_inserter(marks.back()),
+                               [] (const auto &p) { return p.second; });
+                return true;
+            }));
+    REQUIRE(marks.size() == 2);
+    CHECK(std::none_of(marks[0].begin(), marks[0].end(), [] (bool m) { return m; }));
+    CHECK_FALSE(marks[1].front());
+    CHECK(marks[1].back());
+    CHECK(marks[1][marks[1].size() - 2]);
+
+    tracker.select("output_select", Selector(1));
+    expect_audio_paths_to_sink(tracker, *sink_B, {});
+    expect_audio_paths_to_sink(tracker, *sink_C,
+                               {
+                                   { source_B, in_sel, mix, out_sel, sink_C },
+                                   { source_C, mix, out_sel, sink_C },
+                               });
+
+    /* paths from a previously seen selector state are still known */
+    tracker.select("output_select", Selector(0));
+    tracker.select("input_select", Selector(0));
+    expect_audio_paths_to_sink(tracker, *sink_B,
+                               {
+                                   { source_A, in_sel, mix, out_sel, sink_B },
+                                   { source_C, mix, out_sel, sink_B },
+                               });
+    tracker.select("input_select", Selector(1));
+    expect_audio_paths_to_sink(tracker, *sink_A,
+                               {
+                                   { source_B, in_sel, mix, sink_A },
+                                   { source_C, mix, sink_A },
+                               });
+
+    CHECK_FALSE(tracker.enumerate_active_signal_paths_to_sink(
+            *sink_A, [] (const auto &) { return false; }));
+}
+
 TEST_SUITE_END();
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of AuPaD.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "state_shm_writer.hh"
+#include "state_shm_reader.hh"
+
+#include "mock_messages.hh"
+
+#include <unistd.h>
+
+class Fixture
+{
+  protected:
+    std::unique_ptr<MockMessages::Mock> mock_messages;
+    const std::string shm_name_;
+
+  public:
+    explicit Fixture():
+        mock_messages(std::make_unique<MockMessages::Mock>()),
+        shm_name_("/aupad-test-" + std::to_string(getpid()))
+    {
+        MockMessages::singleton = mock_messages.get();
+    }
+
+    ~Fixture()
+    {
+        try
+        {
+            mock_messages->done();
+        }
+        catch(...)
+        {
+            /* no throwing from dtors */
+        }
+
+        MockMessages::singleton = nullptr;
+    }
+
+  protected:
+    std::string shm_name() const { return shm_name_; }
+};
+
+TEST_SUITE_BEGIN("State in shared memory");
+
+TEST_CASE_FIXTURE(Fixture, "Reader sees empty region before first publication")
+{
+    StateSHM::Writer writer(shm_name(), 64);
+    StateSHM::Reader reader(shm_name());
+
+    std::string payload("untouched");
+    CHECK(reader.read(payload) == StateSHM::ReadResult::EMPTY);
+    CHECK(payload == "untouched");
+    CHECK_FALSE(reader.has_changed());
+}
+
+TEST_CASE_FIXTURE(Fixture, "Reader gets published snapshots")
+{
+    StateSHM::Writer writer(shm_name(), 64);
+    StateSHM::Reader reader(shm_name());
+
+    CHECK(writer.publish(R"({"a":1})"));
+    CHECK(reader.has_changed());
+
+    std::string payload;
+    CHECK(reader.read(payload) == StateSHM::ReadResult::OK);
+    CHECK(payload == R"({"a":1})");
+    CHECK_FALSE(reader.has_changed());
+    CHECK(reader.read(payload, true) == StateSHM::ReadResult::UNCHANGED);
+
+    CHECK(writer.publish(R"({"b":2})"));
+    CHECK(reader.has_changed());
+    CHECK(reader.read(payload, true) == StateSHM::ReadResult::OK);
+    CHECK(payload == R"({"b":2})");
+}
+
+TEST_CASE_FIXTURE(Fixture, "Payload too large for region is not published")
+{
+    StateSHM::Writer writer(shm_name(), 8);
+    StateSHM::Reader reader(shm_name());
+
+    CHECK(writer.publish("12345678"));
+
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_ERR,
+        "State of size 9 too large for shared memory (capacity 8)", false);
+    CHECK_FALSE(writer.publish("123456789"));
+
+    std::string payload("untouched");
+    CHECK(reader.read(payload) == StateSHM::ReadResult::EMPTY);
+    CHECK(payload == "untouched");
+}
+
+TEST_CASE_FIXTURE(Fixture, "Reader notices that its writer has gone away")
+{
+    auto writer(std::make_unique<StateSHM::Writer>(shm_name(), 64));
+    StateSHM::Reader reader(shm_name());
+
+    CHECK(writer->publish("first"));
+    writer = nullptr;
+
+    std::string payload;
+    CHECK(reader.read(payload) == StateSHM::ReadResult::RETIRED);
+
+    writer = std::make_unique<StateSHM::Writer>(shm_name(), 64);
+    CHECK(writer->publish("second"));
+
+    reader.reopen();
+    CHECK(reader.read(payload) == StateSHM::ReadResult::OK);
+    CHECK(payload == "second");
+}
+
+TEST_SUITE_END();